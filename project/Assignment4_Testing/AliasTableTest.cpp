@@ -0,0 +1,127 @@
+#include "AliasTable.h"
+
+#include <vector>
+
+using namespace System;
+using namespace System::Text;
+using namespace System::Collections::Generic;
+using namespace Microsoft::VisualStudio::TestTools::UnitTesting;
+
+namespace Assignment4_Testing
+{
+	[TestClass]
+	public ref class AliasTableTest
+	{
+	public:
+
+		[TestMethod]
+		void testAliasTableEmpty()
+		{
+			AliasTable table;
+
+			table.build(std::vector<float>());
+
+			Assert::IsTrue(table.isEmpty());
+		}
+
+		[TestMethod]
+		void testAliasTableSkewedWeights()
+		{
+			float weights[] = { 1.0f, 100.0f, 0.01f, 10.0f, 0.0f, 3.0f };
+			std::vector<float> weightVector(weights, weights + 6);
+			float totalWeight = 114.01f;
+
+			AliasTable table;
+			table.build(weightVector);
+
+			Assert::IsFalse(table.isEmpty());
+
+			// the probabilities are the normalized weights
+			for (unsigned int i = 0; i < weightVector.size(); i++)
+				Assert::AreEqual(weights[i] / totalWeight, table.getProbability(i), 1e-6f);
+
+			AssertFrequencies(table, weightVector.size());
+		}
+
+		// An index without weight is never chosen
+		[TestMethod]
+		void testAliasTableZeroWeight()
+		{
+			float weights[] = { 0.0f, 2.0f, 0.0f, 1.0f };
+			std::vector<float> weightVector(weights, weights + 4);
+
+			AliasTable table;
+			table.build(weightVector);
+
+			Assert::AreEqual(0.0f, table.getProbability(0));
+			Assert::AreEqual(0.0f, table.getProbability(2));
+
+			AssertFrequencies(table, weightVector.size());
+		}
+
+		// If the weights do not sum to a positive number, every index is equally likely
+		[TestMethod]
+		void testAliasTableAllZeroWeights()
+		{
+			AliasTable table;
+			table.build(std::vector<float>(5, 0.0f));
+
+			for (unsigned int i = 0; i < 5; i++)
+				Assert::AreEqual(0.2f, table.getProbability(i), 1e-6f);
+
+			AssertFrequencies(table, 5);
+		}
+
+		// Equal weights never need an alias, so every entry chooses its own index
+		[TestMethod]
+		void testAliasTableEqualWeights()
+		{
+			AliasTable table;
+			table.build(std::vector<float>(4, 3.0f));
+
+			for (unsigned int i = 0; i < 4; i++)
+			{
+				float u = (i + 0.5f) / 4.0f;
+				float v = 0.999f;
+
+				Assert::AreEqual(0.25f, table.getProbability(i), 1e-6f);
+				Assert::AreEqual<System::UInt32>(i, table.chooseIndex(u, v));
+			}
+
+			AssertFrequencies(table, 4);
+		}
+
+	private:
+		// Chooses an index for every point of a grid over the unit square and compares the frequencies
+		// of the indices with their probabilities. The numbers left by the choice should stay in [0, 1).
+		static void AssertFrequencies(const AliasTable &table, unsigned int size)
+		{
+			const int resolution = 500;
+			std::vector<int> counts(size, 0);
+
+			for (int i = 0; i < resolution; i++)
+			{
+				for (int j = 0; j < resolution; j++)
+				{
+					float u = (i + 0.5f) / resolution;
+					float v = (j + 0.5f) / resolution;
+
+					unsigned int index = table.chooseIndex(u, v);
+					Assert::IsTrue(index < size);
+
+					Assert::IsTrue(u >= 0.0f && u < 1.0f);
+					Assert::IsTrue(v >= 0.0f && v < 1.0f);
+
+					counts[index]++;
+				}
+			}
+
+			for (unsigned int i = 0; i < size; i++)
+			{
+				float frequency = counts[i] / (float)(resolution * resolution);
+
+				Assert::AreEqual(table.getProbability(i), frequency, 1e-3f);
+			}
+		}
+	};
+}
@@ -0,0 +1,168 @@
+#include "LightTree.h"
+#include "PointLight.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace System;
+using namespace System::Text;
+using namespace System::Collections::Generic;
+using namespace Microsoft::VisualStudio::TestTools::UnitTesting;
+
+namespace Assignment4_Testing
+{
+	[TestClass]
+	public ref class LightTreeTest
+	{
+	private:
+		std::vector<std::shared_ptr<ILight>> *lights;
+
+		LightTree *lightTree;
+
+	public:
+
+		[TestInitialize()]
+		void Before()
+		{
+			this->lights = new std::vector<std::shared_ptr<ILight>>();
+
+			// two lights with a range of 2, which do not reach each other's position
+			std::shared_ptr<PointLight> light0 = std::make_shared<PointLight>(Vec3Df(0, 0, 0), Vec3Df(1, 1, 1));
+			light0->setFalloff(0.25f);
+			this->lights->push_back(light0);
+
+			std::shared_ptr<PointLight> light1 = std::make_shared<PointLight>(Vec3Df(5, 0, 0), Vec3Df(1, 1, 1));
+			light1->setFalloff(0.25f);
+			this->lights->push_back(light1);
+
+			// two lights without falloff, which reach every point
+			this->lights->push_back(std::make_shared<PointLight>(Vec3Df(0, 5, 0), Vec3Df(1, 1, 1)));
+			this->lights->push_back(std::make_shared<PointLight>(Vec3Df(10, 10, 10), Vec3Df(4, 4, 4)));
+
+			for (unsigned int i = 0; i < this->lights->size(); i++)
+				(*this->lights)[i]->preprocess();
+
+			this->lightTree = new LightTree();
+			this->lightTree->build(*this->lights);
+		}
+
+		[TestCleanup()]
+		void After()
+		{
+			delete this->lightTree;
+			delete this->lights;
+		}
+
+		[TestMethod]
+		void testLightTreeEmpty()
+		{
+			LightTree lightTree;
+			float probability;
+
+			lightTree.build(std::vector<std::shared_ptr<ILight>>());
+
+			Assert::IsTrue(lightTree.isEmpty());
+			Assert::IsTrue(lightTree.chooseLight(Vec3Df(0, 0, 0), 0.5f, probability) == nullptr);
+		}
+
+		[TestMethod]
+		void testLightTreeProbabilitiesSumToOne()
+		{
+			std::vector<Vec3Df> points = GetPoints();
+
+			for (unsigned int i = 0; i < points.size(); i++)
+			{
+				float sum = 0.0f;
+
+				for (unsigned int j = 0; j < this->lights->size(); j++)
+					sum += this->lightTree->getProbability(GetLight(j), points[i]);
+
+				Assert::AreEqual(1.0f, sum, 1e-4f);
+			}
+		}
+
+		// Lights whose range does not reach a point are never chosen for it
+		[TestMethod]
+		void testLightTreeOutOfRange()
+		{
+			// only the first light reaches the first point and only the second light reaches the second point
+			Assert::AreEqual(0.0f, this->lightTree->getProbability(GetLight(1), Vec3Df(1, 0, 0)));
+			Assert::AreEqual(0.0f, this->lightTree->getProbability(GetLight(0), Vec3Df(5, 1, 0)));
+
+			// neither reaches the third point
+			Assert::AreEqual(0.0f, this->lightTree->getProbability(GetLight(0), Vec3Df(20, 20, 20)));
+			Assert::AreEqual(0.0f, this->lightTree->getProbability(GetLight(1), Vec3Df(20, 20, 20)));
+
+			// the lights without falloff reach every point
+			Assert::IsTrue(this->lightTree->getProbability(GetLight(2), Vec3Df(20, 20, 20)) > 0.0f);
+			Assert::IsTrue(this->lightTree->getProbability(GetLight(3), Vec3Df(20, 20, 20)) > 0.0f);
+		}
+
+		// The frequencies with which chooseLight chooses the lights match their probabilities
+		[TestMethod]
+		void testLightTreeChooseLightFrequencies()
+		{
+			const int sampleCount = 100000;
+			std::vector<Vec3Df> points = GetPoints();
+
+			for (unsigned int i = 0; i < points.size(); i++)
+			{
+				std::vector<int> counts(this->lights->size(), 0);
+
+				// stratified numbers cover the range evenly
+				for (int k = 0; k < sampleCount; k++)
+				{
+					float probability;
+					const ILight *light = this->lightTree->chooseLight(points[i], (k + 0.5f) / sampleCount, probability);
+
+					int index = GetLightIndex(light);
+					Assert::IsTrue(index >= 0);
+
+					// the returned probability is the probability of the chosen light
+					Assert::AreEqual(this->lightTree->getProbability(light, points[i]), probability, 1e-5f);
+					Assert::IsTrue(probability > 0.0f);
+
+					counts[index]++;
+				}
+
+				for (unsigned int j = 0; j < this->lights->size(); j++)
+				{
+					float frequency = counts[j] / (float)sampleCount;
+
+					Assert::AreEqual(this->lightTree->getProbability(GetLight(j), points[i]), frequency, 1e-3f);
+				}
+			}
+		}
+
+	private:
+		// Points next to either light with falloff, and a point out of range of both
+		static std::vector<Vec3Df> GetPoints()
+		{
+			std::vector<Vec3Df> points;
+
+			points.push_back(Vec3Df(1, 0, 0));
+			points.push_back(Vec3Df(5, 1, 0));
+			points.push_back(Vec3Df(2.5f, 0, 0));
+			points.push_back(Vec3Df(20, 20, 20));
+
+			return points;
+		}
+
+		const ILight *GetLight(unsigned int index)
+		{
+			return (*this->lights)[index].get();
+		}
+
+		int GetLightIndex(const ILight *light)
+		{
+			for (unsigned int i = 0; i < this->lights->size(); i++)
+			{
+				if (GetLight(i) == light)
+					return i;
+			}
+
+			return -1;
+		}
+	};
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cassert>
+
+#include "AliasTable.h"
+
+AliasTable::AliasTable() {
+}
+
+void AliasTable::build(const std::vector<float> &weights) {
+	unsigned int size = weights.size();
+
+	this->entries.clear();
+	this->entries.resize(size);
+
+	if (size == 0)
+		return;
+
+	double totalWeight = 0.0;
+
+	for (unsigned int i = 0; i < size; i++) {
+		assert(weights[i] >= 0.0f);
+		totalWeight += weights[i];
+	}
+
+	std::vector<double> scaledWeights(size);
+	std::vector<unsigned int> small;
+	std::vector<unsigned int> large;
+
+	// Scale the weights so that their average is one, and sort them by whether they fall short of it
+	for (unsigned int i = 0; i < size; i++) {
+		this->entries[i].probability = totalWeight > 0.0 ? (float)(weights[i] / totalWeight) : 1.0f / size;
+		this->entries[i].alias = i;
+		scaledWeights[i] = totalWeight > 0.0 ? weights[i] * size / totalWeight : 1.0;
+
+		if (scaledWeights[i] < 1.0)
+			small.push_back(i);
+		else
+			large.push_back(i);
+	}
+
+	// Fill up every entry below the average with the excess of an entry above it
+	while (!small.empty() && !large.empty()) {
+		unsigned int less = small.back();
+		unsigned int more = large.back();
+		small.pop_back();
+
+		this->entries[less].threshold = (float)scaledWeights[less];
+		this->entries[less].alias = more;
+
+		scaledWeights[more] -= 1.0 - scaledWeights[less];
+
+		if (scaledWeights[more] < 1.0) {
+			large.pop_back();
+			small.push_back(more);
+		}
+	}
+
+	// The remaining entries are at the average up to rounding errors, so they always keep their own index
+	for (unsigned int i = 0; i < large.size(); i++)
+		this->entries[large[i]].threshold = 1.0f;
+
+	for (unsigned int i = 0; i < small.size(); i++)
+		this->entries[small[i]].threshold = 1.0f;
+}
+
+bool AliasTable::isEmpty() const {
+	return this->entries.empty();
+}
+
+unsigned int AliasTable::chooseIndex(float &u, float &v) const {
+	assert(!this->entries.empty());
+
+	// Choose an entry uniformly, keeping the fraction of the scaled number
+	float scaled = u * this->entries.size();
+	unsigned int index = std::min<unsigned int>((unsigned int)scaled, this->entries.size() - 1);
+	const Entry &entry = this->entries[index];
+
+	u = std::min(scaled - index, 0.99999994f);
+
+	// Decide between the entry and its alias
+	if (v < entry.threshold) {
+		v = std::min(v / entry.threshold, 0.99999994f);
+		return index;
+	}
+
+	v = std::min((v - entry.threshold) / (1.0f - entry.threshold), 0.99999994f);
+	return entry.alias;
+}
+
+float AliasTable::getProbability(unsigned int index) const {
+	assert(index < this->entries.size());
+
+	return this->entries[index].probability;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef ALIASTABLE_H
+#define ALIASTABLE_H
+
+#include <vector>
+
+/**
+ * Implements Walker's alias method, which chooses an index in proportion to its weight in constant time.
+ *
+ * Every entry of the table holds the probability of keeping its own index and the index it is otherwise replaced by.
+ * An entry is chosen uniformly, after which a second random number decides between the index and its alias.
+ * The table is built in linear time with Vose's algorithm, by pairing entries below the average weight with those above it.
+ */
+class AliasTable {
+public:
+	AliasTable();
+
+	/**
+	 * Builds the table over the given weights. If the weights do not sum to a positive number, every index is equally likely.
+	 * @param[in] weights The non-negative weights.
+	 */
+	void build(const std::vector<float> &weights);
+
+	/**
+	 * Tests whether the table contains any index.
+	 * @return True if the table was built over no weights; otherwise false.
+	 */
+	bool isEmpty() const;
+
+	/**
+	 * Chooses an index in proportion to its weight. The first number chooses an entry of the table
+	 * and the second number decides between the entry and its alias, so that the probabilities are
+	 * accurate to the precision of the numbers however many entries the table has. Both numbers are
+	 * replaced by the part that was not needed, which is again uniformly distributed, so that stratified
+	 * numbers remain stratified.
+	 * @param[in,out] u A random number in the range [0, 1).
+	 * @param[in,out] v A random number in the range [0, 1).
+	 * @return The chosen index, the table should not be empty.
+	 */
+	unsigned int chooseIndex(float &u, float &v) const;
+
+	/**
+	 * Gets the probability with which chooseIndex chooses the given index.
+	 * @param index The index.
+	 * @return The probability of the index.
+	 */
+	float getProbability(unsigned int index) const;
+
+private:
+	struct Entry {
+		float threshold;
+		unsigned int alias;
+		float probability;
+	};
+
+	std::vector<Entry> entries;
+};
+
+#endif
\ No newline at end of file
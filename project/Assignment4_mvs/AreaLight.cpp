@@ -2,6 +2,8 @@
 
 #include "AreaLight.h"
 #include "IGeometry.h"
+#include "IMaterial.h"
+#include "Random.h"
 #include "SurfacePoint.h"
 
 AreaLight::AreaLight(std::shared_ptr<IGeometry> geometry) {
@@ -10,26 +12,73 @@ AreaLight::AreaLight(std::shared_ptr<IGeometry> geometry) {
 	this->setGeometry(geometry);
 }
 
+float AreaLight::getPower() const {
+	return ILight::getPower() * this->getGeometry()->getMaterial()->getEmissiveness();
+}
+
 bool AreaLight::sampleLight(const Vec3Df &point, Vec3Df &lightPoint, Vec3Df &lightColor) const {
+	float u, v;
+	Random::sampleUnitSquare(u, v);
+
+	return this->sampleLight(point, u, v, lightPoint, lightColor);
+}
+
+bool AreaLight::sampleLight(const Vec3Df &point, Vec3Df &lightPoint, Vec3Df &lightColor, float &density) const {
+	float u, v;
+	Random::sampleUnitSquare(u, v);
+
+	return this->sampleLight(point, u, v, lightPoint, lightColor, density);
+}
+
+bool AreaLight::sampleLight(const Vec3Df &point, float u, float v, Vec3Df &lightPoint, Vec3Df &lightColor) const {
 	SurfacePoint surface;
-	Vec3Df lightVector;
 
-	// Sample a random point on the surface
-	this->getGeometry()->getRandomSurfacePoint(surface);
+	// Sample a point on the surface uniformly by area
+	this->getGeometry()->sampleSurfacePoint(u, v, surface);
 
 	// Set the light point
 	lightPoint = surface.point;
 
+	return this->calculateEmittedLight(point, surface, lightColor);
+}
+
+bool AreaLight::sampleLight(const Vec3Df &point, float u, float v, Vec3Df &lightPoint, Vec3Df &lightColor, float &density) const {
+	SurfacePoint surface;
+
+	// Sample a point on the surface as seen from the point
+	density = this->getGeometry()->sampleSolidAngle(point, u, v, surface);
+
+	// Set the light point
+	lightPoint = surface.point;
+
+	if (density <= 0.0f)
+		return false;
+
+	return this->calculateEmittedLight(point, surface, lightColor);
+}
+
+bool AreaLight::evaluateLight(const Vec3Df &point, const SurfacePoint &lightSurface, Vec3Df &lightColor, float &density) const {
+	if (!this->calculateEmittedLight(point, lightSurface, lightColor))
+		return false;
+
+	// Calculate the density with which sampleLight chooses the light point
+	density = this->getGeometry()->getSolidAngleDensity(point, lightSurface);
+
+	return density > 0.0f;
+}
+
+bool AreaLight::calculateEmittedLight(const Vec3Df &point, const SurfacePoint &lightSurface, Vec3Df &lightColor) const {
 	// Calculate the light vector and distance
-	lightVector = point - lightPoint;
+	Vec3Df lightVector = point - lightSurface.point;
 	float distance = lightVector.normalize();
+	float cosTheta = Vec3Df::dotProduct(lightSurface.normal, lightVector);
 
-	// If the [point is on the wrong side of the surface return false
-	if (Vec3Df::dotProduct(surface.normal, lightVector) <= 0.0f)
+	// If the point is on the wrong side of the surface return false
+	if (cosTheta <= 0.0f)
 		return false;
 
 	// Set the light's color
-	lightColor = surface.emittedLight(lightVector) * this->calculateIntensity(distance);
+	lightColor = lightSurface.emittedLight(lightVector) * this->calculateIntensity(distance);
 
 	return true;
 }
\ No newline at end of file
@@ -12,6 +12,12 @@ public:
 	 */
 	AreaLight(std::shared_ptr<IGeometry> geometry);
 
+	/**
+	 * Gets an estimate of the total amount of light emitted by the light.
+	 * @return The intensity of the light multiplied by its area and the emissiveness of its material.
+	 */
+	float getPower() const;
+
 	/**
 	 * Calculates the direction from a point on the light source towards the given point
 	 * and the light emitted along this direction.
@@ -21,6 +27,64 @@ public:
 	 * @return Returns true if the point is visible from the light source; otherwise false.
 	 */
 	bool sampleLight(const Vec3Df &point, Vec3Df &lightPoint, Vec3Df &lightColor) const;
+
+	/**
+	 * Samples a point on the geometry of the light as seen from the given point and calculates the light emitted towards
+	 * the given point and the probability density per unit solid angle of the light point.
+	 * @param[in] point A point in the scene.
+	 * @param[out] lightPoint A point on the light source.
+	 * @param[out] lightColor The light emitted along the outgoing vector.
+	 * @param[out] density The probability density of the light point per unit solid angle.
+	 * @return Returns true if the point is visible from the light source; otherwise false.
+	 */
+	bool sampleLight(const Vec3Df &point, Vec3Df &lightPoint, Vec3Df &lightColor, float &density) const;
+
+	/**
+	 * Maps the given point in the unit square to a point on the geometry of the light uniformly by area,
+	 * so that averaging the light of the samples gives the average light emitted by the surface.
+	 * @param[in] point A point in the scene.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] lightPoint A point on the light source.
+	 * @param[out] lightColor The light emitted along the outgoing vector.
+	 * @return Returns true if the point is visible from the light source; otherwise false.
+	 */
+	bool sampleLight(const Vec3Df &point, float u, float v, Vec3Df &lightPoint, Vec3Df &lightColor) const;
+
+	/**
+	 * Maps the given point in the unit square to a point on the geometry of the light as seen from the given point,
+	 * which samples the solid angle of triangles uniformly, and calculates the light emitted towards the given point
+	 * and the probability density per unit solid angle of the light point.
+	 * @param[in] point A point in the scene.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] lightPoint A point on the light source.
+	 * @param[out] lightColor The light emitted along the outgoing vector.
+	 * @param[out] density The probability density of the light point per unit solid angle.
+	 * @return Returns true if the point is visible from the light source; otherwise false.
+	 */
+	bool sampleLight(const Vec3Df &point, float u, float v, Vec3Df &lightPoint, Vec3Df &lightColor, float &density) const;
+
+	/**
+	 * Calculates the light emitted from a point on the geometry of the light towards the given point
+	 * and the probability density per unit solid angle with which sampleLight chooses this light point.
+	 * @param[in] point A point in the scene.
+	 * @param[in] lightSurface A point on the geometry of the light.
+	 * @param[out] lightColor The light emitted towards the point.
+	 * @param[out] density The probability density of the light point per unit solid angle.
+	 * @return Returns true if the light point emits towards the point; otherwise false.
+	 */
+	bool evaluateLight(const Vec3Df &point, const SurfacePoint &lightSurface, Vec3Df &lightColor, float &density) const;
+
+private:
+	/**
+	 * Calculates the light emitted from a point on the geometry of the light towards the given point.
+	 * @param[in] point A point in the scene.
+	 * @param[in] lightSurface A point on the geometry of the light.
+	 * @param[out] lightColor The light emitted towards the point.
+	 * @return Returns true if the light point emits towards the point; otherwise false.
+	 */
+	bool calculateEmittedLight(const Vec3Df &point, const SurfacePoint &lightSurface, Vec3Df &lightColor) const;
 };
 
 #endif
\ No newline at end of file
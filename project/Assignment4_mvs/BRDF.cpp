@@ -1,9 +1,20 @@
+#include <algorithm>
 #include <cassert>
 
 #include "BRDF.h"
+#include "Constants.h"
 #include "IMaterial.h"
+#include "Random.h"
 
 BRDF::BRDF(const IMaterial *material)
 : material(material) {
 	assert(material);
+}
+
+Vec3Df BRDF::sampleIncomingVector(const Vec3Df &, const Vec3Df &normal) const {
+	return Random::sampleCosineHemisphere(normal);
+}
+
+float BRDF::getProbabilityDensity(const Vec3Df &incommingVector, const Vec3Df &, const Vec3Df &normal) const {
+	return std::max(0.0f, Vec3Df::dotProduct(incommingVector, normal)) / Constants::Pi;
 }
\ No newline at end of file
@@ -26,6 +26,24 @@ public:
 	 */
 	virtual Vec3Df reflectance(const Vec3Df &incommingVector, const Vec3Df &reflectedVector, const Vec3Df &normal, const Vec2Df &texCoords, const Vec3Df &light) const = 0;
 
+	/**
+	 * Samples an incoming vector with a density which roughly follows the amount of light reflected from it towards the reflected vector.
+	 * The default samples the hemisphere around the normal with a density proportional to the cosine, which suits diffuse BRDFs.
+	 * @param[in] reflectedVector The vector in the direction that the light is reflected to.
+	 * @param[in] normal The surface normal.
+	 * @return The sampled incoming vector, which may lie below the surface.
+	 */
+	virtual Vec3Df sampleIncomingVector(const Vec3Df &reflectedVector, const Vec3Df &normal) const;
+
+	/**
+	 * Calculates the probability density per unit solid angle with which sampleIncomingVector returns the given incoming vector.
+	 * @param[in] incommingVector The vector in the direction that the light is coming from.
+	 * @param[in] reflectedVector The vector in the direction that the light is reflected to.
+	 * @param[in] normal The surface normal.
+	 * @return The probability density of the incoming vector.
+	 */
+	virtual float getProbabilityDensity(const Vec3Df &incommingVector, const Vec3Df &reflectedVector, const Vec3Df &normal) const;
+
 protected:
 	const IMaterial *material;
 };
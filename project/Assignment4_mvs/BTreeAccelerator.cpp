@@ -1,7 +1,9 @@
 #include "BoundingBox.h"
 #include "BTreeAccelerator.h"
+#include "GeometryPrimitiveSet.h"
 #include "IGeometry.h"
 #include "NoAccelerationStructure.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 
 #include <algorithm>
@@ -24,8 +26,14 @@ void BTreeAccelerator::preprocess()
 	yTree = new BTree(BTree::Coordinate::Y);
 	zTree = new BTree(BTree::Coordinate::Z);
 
-	// the geometry
-	std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry = this->getGeometry();
+	// the geometry, the trees store geometrical objects so only a GeometryPrimitiveSet is supported
+	std::shared_ptr<const GeometryPrimitiveSet> primitives = std::dynamic_pointer_cast<const GeometryPrimitiveSet>(this->getPrimitives());
+
+	if (!primitives)
+		throw BTreeAcceleratorException("The BTreeAccelerator only supports geometry primitives");
+
+	std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry = primitives->getGeometry();
+	this->geometry = geometry;
 
 	float infinity = std::numeric_limits<float>::infinity();
 
@@ -72,7 +80,9 @@ void BTreeAccelerator::preprocess()
 	}
 }
 
-bool BTreeAccelerator::calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const {
+bool BTreeAccelerator::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
+	const Vec3Df &origin = ray.origin;
+	const Vec3Df &dir = ray.direction;
 
 	// take 'origin' as the zero-vector and calculate the destination
 	Vec3Df oDestination = dir - origin;
@@ -120,7 +130,7 @@ bool BTreeAccelerator::calculateClosestIntersection(const Vec3Df &origin, const
 	simpleIntersectionAlgorithm.preprocess();
 
 	// Use the simple intersection algorithm to find the closest intersections
-	return simpleIntersectionAlgorithm.calculateClosestIntersection(origin, dir, intersection);
+	return simpleIntersectionAlgorithm.calculateClosestIntersection(ray, intersection);
 }
 
 float BTreeAccelerator::calculateCoordinateScalar(const Vec3Df& origin, const Vec3Df & destination, BTree::Coordinate coordinate) const
@@ -217,11 +227,11 @@ float BTreeAccelerator::GetCoordinateExtreme(const Vec3Df& origin, const Vec3Df
 	}
 }
 
-bool BTreeAccelerator::calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const {
-	Vec3Df dest = dir * maxDistance;
+bool BTreeAccelerator::calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const {
+	Vec3Df dest = ray.direction * ray.maxDistance;
 
 	// Use the retrieveTriangles to find a list of potential intersecting objects
-	std::vector<std::shared_ptr<IGeometry>> candidateSet = this->retrieveTriangles(origin, dest);
+	std::vector<std::shared_ptr<IGeometry>> candidateSet = this->retrieveTriangles(ray.origin, dest);
 
 	// Constructor a NoAccelerationStructure to perform a simple intersection test
 	NoAccelerationStructure simpleIntersectionAlgorithm;
@@ -229,7 +239,7 @@ bool BTreeAccelerator::calculateAnyIntersection(const Vec3Df &origin, const Vec3
 	simpleIntersectionAlgorithm.preprocess();
 
 	// Use the simple intersection algorithm to find the closest intersections
-	return simpleIntersectionAlgorithm.calculateAnyIntersection(origin, dir, maxDistance, intersection);
+	return simpleIntersectionAlgorithm.calculateAnyIntersection(ray, intersection);
 }
 
 std::vector<std::shared_ptr<IGeometry>> BTreeAccelerator::retrieveTriangles(const Vec3Df & origin, const Vec3Df & dest) const {
@@ -239,7 +249,7 @@ std::vector<std::shared_ptr<IGeometry>> BTreeAccelerator::retrieveTriangles(cons
 
 	if (USE_DEBUG_TRIANGLES)
 	{
-		std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry = this->getGeometry();
+		std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry = this->geometry;
 
 		// Iterate through all geometry in the scene
 		for (std::vector<std::shared_ptr<IGeometry>>::const_iterator it = geometry->begin(); it != geometry->end(); ++it) {
@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "BVHAccelerator.h"
+#include "IPrimitiveSet.h"
+#include "Ray.h"
+#include "RayIntersection.h"
+
+// The number of bins in which the centroids are binned when evaluating the SAH
+static const int BinCount = 16;
+
+// Beyond this depth primitives are split at the median, which guarantees
+// that the depth of the hierarchy never exceeds the size of the traversal stack.
+static const int MaxSAHDepth = 32;
+
+BVHAccelerator::BVHAccelerator()
+: maxLeafSize(4), traversalCost(0.125f), primitives(nullptr) {
+	static_assert(sizeof(LinearNode) == 32, "LinearNode should be 32 bytes");
+}
+
+int BVHAccelerator::getMaxLeafSize() const {
+	return this->maxLeafSize;
+}
+
+float BVHAccelerator::getTraversalCost() const {
+	return this->traversalCost;
+}
+
+void BVHAccelerator::setMaxLeafSize(int maxLeafSize) {
+	assert(maxLeafSize >= 1 && maxLeafSize <= std::numeric_limits<unsigned short>::max());
+
+	this->maxLeafSize = maxLeafSize;
+}
+
+void BVHAccelerator::setTraversalCost(float traversalCost) {
+	assert(traversalCost >= 0.0f);
+
+	this->traversalCost = traversalCost;
+}
+
+void BVHAccelerator::preprocess() {
+	// Keep a plain pointer to the primitives so traversal does not touch the shared_ptr
+	this->primitives = this->getPrimitives().get();
+	this->nodes.clear();
+	this->primitiveIndices.clear();
+	this->unboundedIndices.clear();
+
+	// Compute the bounding box and centroid of each primitive once up front
+	std::vector<BuildPrimitive> primitives;
+	unsigned int primitiveCount = this->primitives->getPrimitiveCount();
+	primitives.reserve(primitiveCount);
+
+	for (unsigned int i = 0; i < primitiveCount; i++) {
+		BoundingBox boundingBox = this->primitives->getBoundingBox(i);
+
+		// Primitives that are not bounded are always tested and kept out of the hierarchy
+		if (boundingBox.isEmpty() || !std::isfinite(boundingBox.getSurfaceArea())) {
+			this->unboundedIndices.push_back(i);
+			continue;
+		}
+
+		BuildPrimitive primitive;
+		primitive.boundingBox = boundingBox;
+		primitive.centroid = boundingBox.getCenter();
+		primitive.index = i;
+
+		primitives.push_back(primitive);
+	}
+
+	if (primitives.empty())
+		return;
+
+	this->buildHierarchy(primitives);
+
+	// The build sorted the primitives so that the primitives in each leaf are contiguous
+	this->primitiveIndices.resize(primitives.size());
+
+	for (unsigned int i = 0; i < primitives.size(); i++) {
+		this->primitiveIndices[i] = primitives[i].index;
+	}
+}
+
+bool BVHAccelerator::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
+	const IPrimitiveSet *primitives = this->primitives;
+	bool intersectsAny = false;
+
+	// Test the unbounded primitives first, a close hit lets the traversal cull more nodes
+	if (!this->unboundedIndices.empty()) {
+		intersectsAny = primitives->calculateClosestIntersection(&this->unboundedIndices[0], this->unboundedIndices.size(), ray, intersection);
+	}
+
+	if (this->nodes.empty())
+		return intersectsAny;
+
+	const LinearNode *nodes = &this->nodes[0];
+	const unsigned int *primitiveIndices = &this->primitiveIndices[0];
+
+	unsigned int stack[MaxDepth];
+	int stackSize = 0;
+	unsigned int current = 0;
+
+	while (true) {
+		const LinearNode &node = nodes[current];
+
+		// The ray is shortened to the closest intersection so far, so this
+		// only visits the node if it is hit in front of that intersection
+		if (node.boundingBox.intersects(ray)) {
+			if (node.primitiveCount > 0) {
+				// The intersection is only updated if a primitive in the leaf is hit closer than the current best intersection
+				if (primitives->calculateClosestIntersection(primitiveIndices + node.offset, node.primitiveCount, ray, intersection))
+					intersectsAny = true;
+			}
+			else {
+				// Visit the child on the near side of the split first, so that the far child
+				// can be culled when the closest intersection lies in front of its bounding box.
+				if (ray.sign[node.axis]) {
+					stack[stackSize++] = current + 1;
+					current = node.offset;
+				}
+				else {
+					stack[stackSize++] = node.offset;
+					current = current + 1;
+				}
+
+				continue;
+			}
+		}
+
+		if (stackSize == 0)
+			break;
+
+		current = stack[--stackSize];
+	}
+
+	return intersectsAny;
+}
+
+bool BVHAccelerator::calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const {
+	const IPrimitiveSet *primitives = this->primitives;
+
+	// Test the unbounded primitives, which are not part of the hierarchy
+	if (!this->unboundedIndices.empty() &&
+		primitives->calculateAnyIntersection(&this->unboundedIndices[0], this->unboundedIndices.size(), ray, intersection))
+		return true;
+
+	if (this->nodes.empty())
+		return false;
+
+	const LinearNode *nodes = &this->nodes[0];
+	const unsigned int *primitiveIndices = &this->primitiveIndices[0];
+
+	unsigned int stack[MaxDepth];
+	int stackSize = 0;
+	unsigned int current = 0;
+
+	while (true) {
+		const LinearNode &node = nodes[current];
+
+		if (node.boundingBox.intersects(ray)) {
+			if (node.primitiveCount > 0) {
+				// If an intersection was found, return it
+				if (primitives->calculateAnyIntersection(primitiveIndices + node.offset, node.primitiveCount, ray, intersection))
+					return true;
+			}
+			else {
+				stack[stackSize++] = node.offset;
+				current = current + 1;
+
+				continue;
+			}
+		}
+
+		if (stackSize == 0)
+			break;
+
+		current = stack[--stackSize];
+	}
+
+	return false;
+}
+
+void BVHAccelerator::buildHierarchy(std::vector<BuildPrimitive> &primitives) {
+	// A binary tree never has more than 2n - 1 nodes
+	this->nodes.reserve(2 * primitives.size() - 1);
+
+	this->build(primitives, 0, primitives.size(), 0);
+}
+
+unsigned int BVHAccelerator::build(std::vector<BuildPrimitive> &primitives, unsigned int begin, unsigned int end, int depth) {
+	unsigned int count = end - begin;
+
+	// Compute the bounds of the primitives and of their centroids
+	BoundingBox boundingBox;
+	BoundingBox centroidBounds;
+
+	for (unsigned int i = begin; i < end; i++) {
+		boundingBox.includeBoundingBox(primitives[i].boundingBox);
+		centroidBounds.includePoint(primitives[i].centroid);
+	}
+
+	if (count == 1)
+		return this->createNode(boundingBox, begin, count, 0);
+
+	// The SAH estimates the probability of a ray hitting a child by the ratio of the child's
+	// surface area to that of its parent. A degenerate parent is treated as always worth splitting.
+	float area = boundingBox.getSurfaceArea();
+	float invArea = area > 0.0f ? 1.0f / area : 0.0f;
+
+	float bestCost = std::numeric_limits<float>::infinity();
+	int bestAxis = -1;
+	int bestBin = 0;
+
+	// Evaluate the binned SAH along all three axes
+	for (int axis = 0; axis < 3; axis++) {
+		float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+
+		// All centroids coincide along this axis, there is nothing to split
+		if (extent <= 0.0f)
+			continue;
+
+		BoundingBox binBoxes[BinCount];
+		unsigned int binCounts[BinCount] = { 0 };
+		float scale = BinCount / extent;
+
+		for (unsigned int i = begin; i < end; i++) {
+			int bin = std::min<int>(BinCount - 1, (int)((primitives[i].centroid[axis] - centroidBounds.min[axis]) * scale));
+
+			binBoxes[bin].includeBoundingBox(primitives[i].boundingBox);
+			binCounts[bin]++;
+		}
+
+		// Sweep from the right to find the area and primitive count above each split
+		float rightAreas[BinCount];
+		unsigned int rightCounts[BinCount];
+		BoundingBox rightBox;
+		unsigned int rightCount = 0;
+
+		for (int bin = BinCount - 1; bin > 0; bin--) {
+			rightBox.includeBoundingBox(binBoxes[bin]);
+			rightCount += binCounts[bin];
+
+			rightAreas[bin] = rightBox.getSurfaceArea();
+			rightCounts[bin] = rightCount;
+		}
+
+		// Sweep from the left and evaluate the cost of splitting between bin and bin + 1
+		BoundingBox leftBox;
+		unsigned int leftCount = 0;
+
+		for (int bin = 0; bin < BinCount - 1; bin++) {
+			leftBox.includeBoundingBox(binBoxes[bin]);
+			leftCount += binCounts[bin];
+
+			if (leftCount == 0 || rightCounts[bin + 1] == 0)
+				continue;
+
+			float cost = this->traversalCost +
+				(leftCount * leftBox.getSurfaceArea() + rightCounts[bin + 1] * rightAreas[bin + 1]) * invArea;
+
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = bin;
+			}
+		}
+	}
+
+	// Intersecting every primitive in a leaf costs one unit per primitive
+	float leafCost = (float)count;
+
+	if (count <= (unsigned int)this->maxLeafSize && (bestAxis < 0 || leafCost <= bestCost))
+		return this->createNode(boundingBox, begin, count, 0);
+
+	unsigned int mid;
+
+	if (bestAxis < 0 || depth >= MaxSAHDepth) {
+		// Either all centroids coincide or the hierarchy is getting too deep,
+		// split the range at the median along the widest axis to keep the leaves small.
+		Vec3Df extent = centroidBounds.max - centroidBounds.min;
+		int axis = (extent[0] >= extent[1] && extent[0] >= extent[2]) ? 0 : (extent[1] >= extent[2] ? 1 : 2);
+
+		mid = begin + count / 2;
+		bestAxis = axis;
+
+		std::nth_element(
+			primitives.begin() + begin,
+			primitives.begin() + mid,
+			primitives.begin() + end,
+			[=](const BuildPrimitive &a, const BuildPrimitive &b) {
+				return a.centroid[axis] < b.centroid[axis];
+			});
+	}
+	else {
+		// Partition the primitives on the side of the best split
+		float scale = BinCount / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+		float min = centroidBounds.min[bestAxis];
+
+		std::vector<BuildPrimitive>::iterator midIt = std::partition(
+			primitives.begin() + begin,
+			primitives.begin() + end,
+			[=](const BuildPrimitive &primitive) {
+				return std::min<int>(BinCount - 1, (int)((primitive.centroid[bestAxis] - min) * scale)) <= bestBin;
+			});
+
+		mid = midIt - primitives.begin();
+	}
+
+	// The first child is built directly after its parent, the parent stores the index of the second child
+	unsigned int index = this->createNode(boundingBox, 0, 0, bestAxis);
+
+	this->build(primitives, begin, mid, depth + 1);
+	this->nodes[index].offset = this->build(primitives, mid, end, depth + 1);
+
+	return index;
+}
+
+unsigned int BVHAccelerator::createNode(const BoundingBox &boundingBox, unsigned int offset, unsigned int primitiveCount, int axis) {
+	LinearNode node;
+	node.boundingBox = boundingBox;
+	node.offset = offset;
+	node.primitiveCount = (unsigned short)primitiveCount;
+	node.axis = (unsigned char)axis;
+	node.padding = 0;
+
+	this->nodes.push_back(node);
+
+	return this->nodes.size() - 1;
+}
\ No newline at end of file
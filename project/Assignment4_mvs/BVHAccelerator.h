@@ -0,0 +1,156 @@
+#ifndef BVHACCELERATOR_H
+#define BVHACCELERATOR_H
+
+#include <vector>
+
+#include "BoundingBox.h"
+#include "IAccelerationStructure.h"
+
+class IPrimitiveSet;
+class Ray;
+class RayIntersection;
+
+/**
+ * Implements a bounding volume hierarchy which is built top-down using
+ * the surface area heuristic (SAH) evaluated over a fixed number of bins.
+ *
+ * The hierarchy is stored as a single array of 32 byte nodes in depth-first order,
+ * so the first child of an interior node directly follows its parent. Leaves refer to
+ * a range in a packed array of primitive indices.
+ *
+ * Primitives without a bounding box, such as planes, cannot be placed in the hierarchy
+ * and are kept in a separate list which is tested for every ray.
+ *
+ * When used for the scene, geometry that has its own acceleration structure (such as a MeshGeometry)
+ * acts as a bottom-level structure: leaves of this hierarchy delegate the ray to it.
+ */
+class BVHAccelerator : public IAccelerationStructure {
+public:
+	BVHAccelerator();
+
+	/**
+	 * Gets the maximum number of primitives stored in a single leaf.
+	 * @return The maximum number of primitives stored in a single leaf.
+	 */
+	int getMaxLeafSize() const;
+
+	/**
+	 * Gets the cost of traversing a node relative to the cost of intersecting a primitive.
+	 * @return The cost of traversing a node relative to the cost of intersecting a primitive.
+	 */
+	float getTraversalCost() const;
+
+	/**
+	 * Sets the maximum number of primitives stored in a single leaf.
+	 * Nodes with more primitives are always split, smaller nodes are only split if the SAH says so.
+	 * @param maxLeafSize The maximum number of primitives stored in a single leaf.
+	 */
+	void setMaxLeafSize(int maxLeafSize);
+
+	/**
+	 * Sets the cost of traversing a node relative to the cost of intersecting a primitive.
+	 * Higher values produce shallower trees with larger leaves.
+	 * @param traversalCost The cost of traversing a node relative to the cost of intersecting a primitive.
+	 */
+	void setTraversalCost(float traversalCost);
+
+	/**
+	 * Perform any necessary preprocessing.
+	 */
+	void preprocess();
+
+	/*
+	 * Returns whether any object is hit by the given ray and sets the intersection parameter
+	 * to the RayIntersection representing the closest point of intersection.
+	 * @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
+	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	 * @return True if the ray intersected an object; otherwise false.
+	 */
+	bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const;
+
+	/*
+	 * Returns whether any object is hit by the given ray and sets the intersection parameter
+	 * to the RayIntersection representing the point of intersection.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
+	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	 * @return True if the ray intersected an object; otherwise false.
+	 */
+	bool calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const;
+
+protected:
+	/**
+	 * The maximum depth of the hierarchy, which is the size of the traversal stack.
+	 */
+	static const int MaxDepth = 64;
+
+	/**
+	 * A node in the flattened hierarchy, two nodes fit in a single cache line.
+	 */
+	struct LinearNode {
+		/**
+		 * A box bounding all primitives below this node.
+		 */
+		BoundingBox boundingBox;
+
+		/**
+		 * For leaves the offset of the first primitive in the primitive index array,
+		 * for interior nodes the index of the second child. The first child directly follows its parent.
+		 */
+		unsigned int offset;
+
+		/**
+		 * The number of primitives in a leaf, zero for interior nodes.
+		 */
+		unsigned short primitiveCount;
+
+		/**
+		 * The axis along which an interior node was split.
+		 */
+		unsigned char axis;
+
+		unsigned char padding;
+	};
+
+	/**
+	 * The bounding box and centroid of a primitive, used while building the hierarchy.
+	 */
+	struct BuildPrimitive {
+		BoundingBox boundingBox;
+		Vec3Df centroid;
+		unsigned int index;
+	};
+
+	/**
+	 * Builds the hierarchy for the given primitives and stores its nodes in depth-first order.
+	 * @param[in,out] primitives The primitives, reordered so that the primitives of each leaf are contiguous.
+	 */
+	virtual void buildHierarchy(std::vector<BuildPrimitive> &primitives);
+
+	/**
+	 * Appends a node to the node array.
+	 * @return The index of the new node.
+	 */
+	unsigned int createNode(const BoundingBox &boundingBox, unsigned int offset, unsigned int primitiveCount, int axis);
+
+	std::vector<LinearNode> nodes;
+
+private:
+	/**
+	 * Recursively builds the hierarchy for the primitives in the range [begin, end)
+	 * and appends its nodes in depth-first order.
+	 * @param[in,out] primitives The primitives, reordered so that the primitives of each leaf are contiguous.
+	 * @param begin The index of the first primitive in the range.
+	 * @param end One past the index of the last primitive in the range.
+	 * @param depth The depth of the node in the hierarchy.
+	 * @return The index of the node created for the given range.
+	 */
+	unsigned int build(std::vector<BuildPrimitive> &primitives, unsigned int begin, unsigned int end, int depth);
+
+	int maxLeafSize;
+	float traversalCost;
+	std::vector<unsigned int> primitiveIndices;
+	std::vector<unsigned int> unboundedIndices;
+	const IPrimitiveSet *primitives;
+};
+
+#endif
\ No newline at end of file
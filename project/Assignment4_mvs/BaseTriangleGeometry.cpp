@@ -1,12 +1,19 @@
+#include <algorithm>
 #include <math.h>
 
 #include "BaseTriangleGeometry.h"
 #include "Constants.h"
 #include "mesh.h"
 #include "Random.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 #include "SurfacePoint.h"
 
+// Below this solid angle the spherical triangle is too thin to be sampled accurately in single precision,
+// while sampling by area is nearly as good. Close to a hemisphere the sampling is also inaccurate.
+static const float MinSolidAngle = 3e-4f;
+static const float MaxSolidAngle = 6.22f;
+
 void BaseTriangleGeometry::preprocess() {
 	// Get the vertices for the triangle
 	Vec3Df vertex0 = this->getVertex0();
@@ -20,7 +27,8 @@ void BaseTriangleGeometry::preprocess() {
 	this->tangent = vertex1 - vertex0;
 	this->bitangent = vertex2 - vertex0;
 	this->normal = Vec3Df::crossProduct(this->tangent, this->bitangent);
-	this->area = this->normal.normalize();
+	// The cross product spans a parallelogram, the triangle has half its area
+	this->area = 0.5f * this->normal.normalize();
 	this->tangent.normalize();
 	this->bitangent.normalize();
 }
@@ -35,7 +43,10 @@ float BaseTriangleGeometry::getArea() const {
 //
 // Logic herein relies heavily on the slides from college as well as data from the following source:
 // https://courses.cs.washington.edu/courses/cse457/09sp/lectures/triangle_intersection.pdf
-bool BaseTriangleGeometry::calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const {
+bool BaseTriangleGeometry::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
+	const Vec3Df &origin = ray.origin;
+	const Vec3Df &dir = ray.direction;
+
 	// Get the vertices for the triangle
 	Vec3Df vertex0 = this->getVertex0();
 	Vec3Df vertex1 = this->getVertex1();
@@ -50,12 +61,6 @@ bool BaseTriangleGeometry::calculateClosestIntersection(const Vec3Df &origin, co
 	{
 		return false;
 	}
-	else if (dot_dir_normal > 0.0f) {
-		intersection.isInside = true;
-	}
-	else {
-		intersection.isInside = false;
-	}
 
 	// to calculate the length of the ray that goes towards the triangle, we can calculate 
 	// D = n * v_0
@@ -73,8 +78,8 @@ bool BaseTriangleGeometry::calculateClosestIntersection(const Vec3Df &origin, co
 	float t = (d - dot_origin_normal) / dot_dir_normal;
 
 	// If the distance it negative it means the intersection occured behind the ray,
-	// thus we should return false.
-	if (t < 0) 
+	// thus we should return false. The same goes for intersections outside the interval of the ray.
+	if (t < 0 || t < ray.minDistance || t > ray.maxDistance) 
 	{
 		return false;
 	}
@@ -91,13 +96,16 @@ bool BaseTriangleGeometry::calculateClosestIntersection(const Vec3Df &origin, co
 		// since the ray-length is less than the already stored data (or has not been stored yet), we 
 		// can put the data for the intersection into the object.
 		intersection.hitPoint = hitPoint;
-		intersection.geometry = this->shared_from_this();
+		intersection.geometry = this;
+		intersection.isInside = dot_dir_normal > 0.0f;
 
 		// also store the original data here.
 		intersection.origin = origin;
 		intersection.direction = dir;
 		intersection.distance = t;
 
+		ray.maxDistance = t;
+
 		return true;
 	}
 
@@ -118,11 +126,90 @@ void BaseTriangleGeometry::getSurfacePoint(const RayIntersection &intersection,
 }
 
 void BaseTriangleGeometry::getRandomSurfacePoint(SurfacePoint &surface) const {
-	surface.geometry = this->shared_from_this();
-	surface.point = this->calculateRandomPoint();
+	float u, v;
+
+	// Get two numbers in the range [0, 1]
+	Random::sampleUnitSquare(u, v);
+
+	this->sampleSurfacePoint(u, v, surface);
+}
+
+void BaseTriangleGeometry::sampleSurfacePoint(float u, float v, SurfacePoint &surface) const {
+	surface.geometry = this;
+	surface.point = this->calculateUniformPoint(u, v);
+	surface.normal = this->normal;
+	surface.texCoords = this->calculateBarycentricCoordinates(surface.point);
+	surface.isInside = false;
+}
+
+float BaseTriangleGeometry::sampleSolidAngle(const Vec3Df &point, float u, float v, SurfacePoint &surface) const {
+	Vec3Df a, b, c;
+	float solidAngle = this->calculateSolidAngle(point, a, b, c);
+
+	// Fall back to sampling by area where the spherical triangle cannot be sampled accurately
+	if (solidAngle < MinSolidAngle || solidAngle > MaxSolidAngle)
+		return IGeometry::sampleSolidAngle(point, u, v, surface);
+
+	// The interior angle of the spherical triangle at a, between the great circles through b and c
+	Vec3Df normalAB = Vec3Df::crossProduct(a, b);
+	Vec3Df normalCA = Vec3Df::crossProduct(c, a);
+
+	if (normalAB.normalize() <= 0.0f || normalCA.normalize() <= 0.0f)
+		return IGeometry::sampleSolidAngle(point, u, v, surface);
+
+	float cosAlpha = std::max(-1.0f, std::min(1.0f, -Vec3Df::dotProduct(normalAB, normalCA)));
+	float sinAlpha = sqrtf(std::max(0.0f, 1.0f - cosAlpha * cosAlpha));
+
+	// Choose the sub-triangle a, b, c' with a fraction u of the solid angle (Arvo, 1995),
+	// its angle at a plus the angles at b and c' exceed pi by its solid angle
+	float subAngle = Constants::Pi + u * solidAngle;
+	float sinSub = sinf(subAngle);
+	float cosSub = cosf(subAngle);
+	float sinPhi = sinSub * cosAlpha - cosSub * sinAlpha;
+	float cosPhi = cosSub * cosAlpha + sinSub * sinAlpha;
+	float k1 = cosPhi + cosAlpha;
+	float k2 = sinPhi - sinAlpha * Vec3Df::dotProduct(a, b);
+	float cosB = (k2 + (k2 * cosPhi - k1 * sinPhi) * cosAlpha) / ((k2 * sinPhi + k1 * cosPhi) * sinAlpha);
+	cosB = std::max(-1.0f, std::min(1.0f, cosB));
+	float sinB = sqrtf(std::max(0.0f, 1.0f - cosB * cosB));
+
+	// Find the third vertex c' on the arc from a to c
+	Vec3Df towardsC = c - Vec3Df::dotProduct(c, a) * a;
+	towardsC.normalize();
+	Vec3Df subC = cosB * a + sinB * towardsC;
+
+	// Choose the direction on the arc from b to c' with a fraction v of the distance measured by the cosine
+	float cosTheta = 1.0f - v * (1.0f - Vec3Df::dotProduct(subC, b));
+	float sinTheta = sqrtf(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+	Vec3Df towardsSubC = subC - Vec3Df::dotProduct(subC, b) * b;
+	towardsSubC.normalize();
+	Vec3Df direction = cosTheta * b + sinTheta * towardsSubC;
+
+	// Find the point on the triangle in the chosen direction
+	float cosNormal = Vec3Df::dotProduct(direction, this->normal);
+
+	if (cosNormal == 0.0f)
+		return IGeometry::sampleSolidAngle(point, u, v, surface);
+
+	surface.geometry = this;
+	surface.point = point + direction * (Vec3Df::dotProduct(this->getVertex0() - point, this->normal) / cosNormal);
 	surface.normal = this->normal;
 	surface.texCoords = this->calculateBarycentricCoordinates(surface.point);
 	surface.isInside = false;
+
+	// Directions are distributed uniformly over the solid angle
+	return 1.0f / solidAngle;
+}
+
+float BaseTriangleGeometry::getSolidAngleDensity(const Vec3Df &point, const SurfacePoint &surface) const {
+	Vec3Df a, b, c;
+	float solidAngle = this->calculateSolidAngle(point, a, b, c);
+
+	// Make the same choice as sampleSolidAngle
+	if (solidAngle < MinSolidAngle || solidAngle > MaxSolidAngle)
+		return IGeometry::getSolidAngleDensity(point, surface);
+
+	return 1.0f / solidAngle;
 }
 
 BoundingBox BaseTriangleGeometry::getBoundingBox() const {
@@ -206,12 +293,7 @@ Vec2Df BaseTriangleGeometry::calculateBarycentricCoordinates(const Vec3Df &point
 	return Vec2Df(u, v);
 }
 
-Vec3Df BaseTriangleGeometry::calculateRandomPoint() const {
-	float u, v;
-
-	// Get two numbers in the range [0, 1]
-	Random::sampleUnitSquare(u, v);
-
+Vec3Df BaseTriangleGeometry::calculateUniformPoint(float u, float v) const {
 	// Calculate the square root of the first number
 	float sqrtU = sqrtf(u);
 
@@ -224,4 +306,21 @@ Vec3Df BaseTriangleGeometry::calculateRandomPoint() const {
 		(sqrtU * v) * this->getVertex2();
 
 	return point;
+}
+
+float BaseTriangleGeometry::calculateSolidAngle(const Vec3Df &point, Vec3Df &a, Vec3Df &b, Vec3Df &c) const {
+	// Project the vertices onto the unit sphere around the point
+	a = this->getVertex0() - point;
+	b = this->getVertex1() - point;
+	c = this->getVertex2() - point;
+
+	if (a.normalize() <= 0.0f || b.normalize() <= 0.0f || c.normalize() <= 0.0f)
+		return 0.0f;
+
+	// The formula of Van Oosterom and Strackee, which is accurate for small solid angles
+	float numerator = fabsf(Vec3Df::dotProduct(a, Vec3Df::crossProduct(b, c)));
+	float denominator = 1.0f + Vec3Df::dotProduct(a, b) + Vec3Df::dotProduct(b, c) + Vec3Df::dotProduct(c, a);
+	float solidAngle = 2.0f * atan2f(numerator, denominator);
+
+	return solidAngle > 0.0f ? solidAngle : 0.0f;
 }
\ No newline at end of file
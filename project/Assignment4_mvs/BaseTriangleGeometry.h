@@ -25,12 +25,11 @@ public:
 	/*
 	 * Returns whether any object is hit by the given ray and sets the intersection parameter
 	 * to the RayIntersection representing the closest point of intersection.
-	 * @param[in] origin The origin of the ray.
-	 * @param[in] dir The direction of the ray.
+	 * @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
 	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	 * @return True if the ray intersected an object; otherwise false.
 	 */
-	bool calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const;
+	bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const;
 
 	virtual Vec3Df getVertex0() const = 0;
 	virtual Vec3Df getVertex1() const = 0;
@@ -49,6 +48,35 @@ public:
 	 */
 	virtual void getRandomSurfacePoint(SurfacePoint &surface) const;
 
+	/**
+	 * Maps a point in the unit square to a surface point on this triangle, uniformly by area.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] surface The surface point.
+	 */
+	void sampleSurfacePoint(float u, float v, SurfacePoint &surface) const;
+
+	/**
+	 * Maps a point in the unit square to a surface point on this triangle, uniformly by the solid angle
+	 * the triangle covers as seen from the given point. Spherical triangles that are too small or too large
+	 * to be sampled accurately are sampled by area instead.
+	 * @param[in] point The point from which the triangle is seen.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] surface The surface point.
+	 * @return The probability density of the surface point per unit solid angle, or zero if it cannot be seen from the point.
+	 */
+	float sampleSolidAngle(const Vec3Df &point, float u, float v, SurfacePoint &surface) const;
+
+	/**
+	 * Calculates the probability density per unit solid angle with which sampleSolidAngle
+	 * samples the given surface point as seen from the given point.
+	 * @param[in] point The point from which the triangle is seen.
+	 * @param[in] surface A surface point on this triangle.
+	 * @return The probability density of the surface point per unit solid angle, or zero if it cannot be seen from the point.
+	 */
+	float getSolidAngleDensity(const Vec3Df &point, const SurfacePoint &surface) const;
+
 	BoundingBox getBoundingBox() const;
 
 private:
@@ -72,10 +100,22 @@ private:
 	Vec2Df calculateBarycentricCoordinates(const Vec3Df &point) const;
 
 	/**
-	 * Calculates a random point on the triangle.
-	 * @return A random point on the triangle.
+	 * Maps a point in the unit square to a point on the triangle, uniformly by area.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @return A point on the triangle.
+	 */
+	Vec3Df calculateUniformPoint(float u, float v) const;
+
+	/**
+	 * Calculates the solid angle covered by the triangle as seen from the given point.
+	 * @param[in] point A point.
+	 * @param[out] a The direction from the point towards the first vertex.
+	 * @param[out] b The direction from the point towards the second vertex.
+	 * @param[out] c The direction from the point towards the third vertex.
+	 * @return The solid angle covered by the triangle, or zero if the point coincides with a vertex.
 	 */
-	Vec3Df calculateRandomPoint() const;
+	float calculateSolidAngle(const Vec3Df &point, Vec3Df &a, Vec3Df &b, Vec3Df &c) const;
 
 	float area;
 	Vec3Df tangent;
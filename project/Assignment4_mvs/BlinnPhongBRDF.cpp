@@ -3,8 +3,10 @@
 #include <cmath>
 
 #include "BlinnPhongBRDF.h"
+#include "Constants.h"
 #include "IMaterial.h"
 #include "ITexture.h"
+#include "Random.h"
 
 BlinnPhongBRDF::BlinnPhongBRDF(const IMaterial *material)
 : BRDF(material) {
@@ -24,3 +26,40 @@ Vec3Df BlinnPhongBRDF::reflectance(const Vec3Df &incomingVector, const Vec3Df &r
 
 	return light * this->material->sampleColor(texCoords) * std::pow(NdotH, this->material->getShininess());
 }
+
+
+Vec3Df BlinnPhongBRDF::sampleIncomingVector(const Vec3Df &reflectedVector, const Vec3Df &normal) const {
+	// Get two unit vectors orthogonal to the normal
+	Vec3Df u, v;
+	normal.getTwoOrthogonals(u, v);
+	u.normalize();
+	v.normalize();
+
+	// Sample a half vector with a density proportional to (N.H)^shininess * N.H
+	float phi = Random::randUnit() * Constants::TwoPi;
+	float cosTheta = std::pow(1.0f - Random::randUnit(), 1.0f / (this->material->getShininess() + 2.0f));
+	float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+
+	Vec3Df H = sinTheta * std::cos(phi) * u + sinTheta * std::sin(phi) * v + cosTheta * normal;
+
+	// Mirror the reflected vector in the half vector
+	return 2.0f * Vec3Df::dotProduct(reflectedVector, H) * H - reflectedVector;
+}
+
+float BlinnPhongBRDF::getProbabilityDensity(const Vec3Df &incomingVector, const Vec3Df &reflectedVector, const Vec3Df &normal) const {
+	Vec3Df H = incomingVector + reflectedVector;
+
+	if (H.normalize() == 0.0f)
+		return 0.0f;
+
+	float NdotH = std::max<float>(0, Vec3Df::dotProduct(normal, H));
+	float VdotH = Vec3Df::dotProduct(reflectedVector, H);
+
+	if (VdotH <= 0.0f)
+		return 0.0f;
+
+	// The density of the half vector, divided by the Jacobian of the reflection
+	float shininess = this->material->getShininess();
+
+	return (shininess + 2.0f) / Constants::TwoPi * std::pow(NdotH, shininess + 1.0f) / (4.0f * VdotH);
+}
\ No newline at end of file
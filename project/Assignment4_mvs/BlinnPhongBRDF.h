@@ -27,6 +27,23 @@ public:
 	 * @return The amount of light reflected from the incoming towards the outgoing vector.
 	 */
 	Vec3Df reflectance(const Vec3Df &incomingVector, const Vec3Df &reflectedVector, const Vec3Df &normal, const Vec2Df &texCoords, const Vec3Df &light) const;
+
+	/**
+	 * Samples an incoming vector by sampling a half vector with a density proportional to the lobe of the BRDF.
+	 * @param[in] reflectedVector The vector in the direction that the light is reflected to.
+	 * @param[in] normal The surface normal.
+	 * @return The sampled incoming vector, which may lie below the surface.
+	 */
+	Vec3Df sampleIncomingVector(const Vec3Df &reflectedVector, const Vec3Df &normal) const;
+
+	/**
+	 * Calculates the probability density per unit solid angle with which sampleIncomingVector returns the given incoming vector.
+	 * @param[in] incomingVector The vector in the direction that the light is coming from.
+	 * @param[in] reflectedVector The vector in the direction that the light is reflected to.
+	 * @param[in] normal The surface normal.
+	 * @return The probability density of the incoming vector.
+	 */
+	float getProbabilityDensity(const Vec3Df &incomingVector, const Vec3Df &reflectedVector, const Vec3Df &normal) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <cassert>
+
+#include "BlueNoiseSampler.h"
+#include "Random.h"
+#include "SobolSampler.h"
+
+namespace {
+	/**
+	 * Interleaves the lower bits of x and y into a Morton code.
+	 */
+	unsigned int getMortonCode(unsigned int x, unsigned int y, int bits) {
+		unsigned int result = 0;
+
+		for (int i = 0; i < bits; i++) {
+			result |= ((x >> i) & 1) << (2 * i);
+			result |= ((y >> i) & 1) << (2 * i + 1);
+		}
+
+		return result;
+	}
+}
+
+BlueNoiseSampler::BlueNoiseSampler(int samplesPerPixel)
+: BlueNoiseSampler(samplesPerPixel, 0) {
+}
+
+BlueNoiseSampler::BlueNoiseSampler(int samplesPerPixel, unsigned int seed)
+: seed(seed), sampleBits(0) {
+	assert(samplesPerPixel >= 1);
+
+	// Round the number of samples up to a power of two, so each pixel owns a block of the sequence
+	while ((1 << this->sampleBits) < samplesPerPixel && this->sampleBits < 24)
+		this->sampleBits++;
+
+	// The rest of the 32 bits of the index select the pixel within the repeating pattern
+	this->pixelBits = std::min(10, (32 - this->sampleBits) / 2);
+}
+
+unsigned int BlueNoiseSampler::getSample(int x, int y, unsigned int sampleIndex, unsigned int dimension) const {
+	// Samples beyond the block of a pixel continue in a block of a differently scrambled sequence
+	unsigned int round = sampleIndex >> this->sampleBits;
+	unsigned int sample = sampleIndex & ((1u << this->sampleBits) - 1);
+
+	unsigned int pixel = getMortonCode((unsigned int)x, (unsigned int)y, this->pixelBits);
+	unsigned int index = (pixel << this->sampleBits) | sample;
+
+	// Every pixel shares the scrambles, so that the points of neighbouring pixels stay stratified
+	unsigned int group = dimension / SobolSampler::Dimensions;
+	unsigned int seed = Random::generate(this->seed, round, group);
+
+	return SobolSampler::getScrambledSobol(index, dimension % SobolSampler::Dimensions, seed);
+}
\ No newline at end of file
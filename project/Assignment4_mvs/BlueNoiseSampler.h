@@ -0,0 +1,47 @@
+#ifndef BLUENOISESAMPLER_H
+#define BLUENOISESAMPLER_H
+
+#include "ISampler.h"
+
+/**
+ * Represents a sampler which distributes the error of neighbouring pixels as blue noise.
+ *
+ * All pixels share a single Owen-scrambled Sobol sequence. The pixels are ordered along a Morton curve and each pixel
+ * takes a consecutive block of points, so neighbouring pixels together form a well stratified set of points and
+ * their errors are negatively correlated. Scrambling the index shuffles the pixels hierarchically, which hides the
+ * structure of the curve. This is the screen-space blue noise technique of Ahmed and Wonka.
+ * The pattern repeats every 1024 pixels in either direction, or fewer when many samples are taken per pixel.
+ */
+class BlueNoiseSampler : public ISampler {
+public:
+	/**
+	 * Initializes a BlueNoiseSampler for the given number of samples per pixel.
+	 * @param samplesPerPixel The number of samples taken per pixel, the error is distributed best
+	 * if this is a power of two and the render takes exactly this many samples.
+	 */
+	explicit BlueNoiseSampler(int samplesPerPixel);
+
+	/**
+	 * Initializes a BlueNoiseSampler for the given number of samples per pixel with the given seed.
+	 * @param samplesPerPixel The number of samples taken per pixel.
+	 * @param seed The seed, which selects a different set of scrambles.
+	 */
+	BlueNoiseSampler(int samplesPerPixel, unsigned int seed);
+
+	/**
+	 * Gets the given dimension of a sample of the given pixel.
+	 * @param x The x-coordinate of the pixel.
+	 * @param y The y-coordinate of the pixel.
+	 * @param sampleIndex The index of the sample within the pixel.
+	 * @param dimension The index of the random number within the sample.
+	 * @return An unsigned integer in the range [0, UINT_MAX], which maps to [0, 1) when divided by 2^32.
+	 */
+	unsigned int getSample(int x, int y, unsigned int sampleIndex, unsigned int dimension) const;
+
+private:
+	unsigned int seed;
+	int sampleBits;
+	int pixelBits;
+};
+
+#endif
\ No newline at end of file
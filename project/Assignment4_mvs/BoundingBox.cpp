@@ -2,6 +2,7 @@
 #include <limits>
 
 #include "BoundingBox.h"
+#include "Ray.h"
 
 BoundingBox::BoundingBox() :
 min(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()),
@@ -12,36 +13,44 @@ BoundingBox::BoundingBox(const Vec3Df &min, const Vec3Df &max)
 : min(min), max(max) {
 }
 
-bool BoundingBox::intersects(const Vec3Df &origin, const Vec3Df &dir) const {
+bool BoundingBox::intersects(const Ray &ray) const {
 	float distance;
 
-	return this->intersects(origin, dir, distance);
+	return this->intersects(ray, distance);
 }
 
-bool BoundingBox::intersects(const Vec3Df &origin, const Vec3Df &dir, float &distance) const {
-	float Tx_min = (this->min[0] - origin[0]) / dir[0];
-	float Ty_min = (this->min[1] - origin[1]) / dir[1];
-	float Tz_min = (this->min[2] - origin[2]) / dir[2];
-	float Tx_max = (this->max[0] - origin[0]) / dir[0];
-	float Ty_max = (this->max[1] - origin[1]) / dir[1];
-	float Tz_max = (this->max[2] - origin[2]) / dir[2];
-	
-	float Tin_x = std::min<float>(Tx_min, Tx_max);
-	float Tout_x = std::max<float>(Tx_min, Tx_max);
-	float Tin_y = std::min<float>(Ty_min, Ty_max);
-	float Tout_y = std::max<float>(Ty_min, Ty_max);
-	float Tin_z = std::min<float>(Tz_min, Tz_max);
-	float Tout_z = std::max<float>(Tz_min, Tz_max);
-	
-	float Tin = std::max<float>(Tin_x, std::max<float>(Tin_y, Tin_z));
-	float Tout = std::min<float>(Tout_x, std::min<float>(Tout_y, Tout_z));
-	
-	if(Tin > Tout || Tout < 0){
+bool BoundingBox::intersects(const Ray &ray, float &distance) const {
+	float exitDistance;
+
+	return this->intersects(ray, distance, exitDistance);
+}
+
+bool BoundingBox::intersects(const Ray &ray, float &entryDistance, float &exitDistance) const {
+	// Start with the interval of the ray and clip it against the slab of each axis.
+	// The sign of the direction determines which side of the slab the ray enters through.
+	float Tin = ray.minDistance;
+	float Tout = ray.maxDistance;
+
+	for (int i = 0; i < 3; i++) {
+		float Tnear = ((ray.sign[i] ? this->max[i] : this->min[i]) - ray.origin[i]) * ray.invDirection[i];
+		float Tfar = ((ray.sign[i] ? this->min[i] : this->max[i]) - ray.origin[i]) * ray.invDirection[i];
+
+		// A ray parallel to a slab whose origin lies on its boundary yields NaN,
+		// which fails both comparisons and leaves the interval unchanged
+		if (Tnear > Tin)
+			Tin = Tnear;
+
+		if (Tfar < Tout)
+			Tout = Tfar;
+	}
+
+	if (Tin > Tout) {
 		return false;
 	}
-	
-	distance = Tin;
-	
+
+	entryDistance = Tin;
+	exitDistance = Tout;
+
 	return true;
 }
 
@@ -52,10 +61,31 @@ bool BoundingBox::intersects(const BoundingBox &other) const {
 		this->max[2] >= other.min[2] && this->min[2] <= other.max[2];
 }
 
+bool BoundingBox::contains(const BoundingBox &other) const {
+	return
+		this->min[0] <= other.min[0] && this->max[0] >= other.max[0] &&
+		this->min[1] <= other.min[1] && this->max[1] >= other.max[1] &&
+		this->min[2] <= other.min[2] && this->max[2] >= other.max[2];
+}
+
+bool BoundingBox::isEmpty() const {
+	return this->min[0] > this->max[0] || this->min[1] > this->max[1] || this->min[2] > this->max[2];
+}
+
 Vec3Df BoundingBox::getCenter() const {
 	return (this->min + this->max) * 0.5f;
 }
 
+float BoundingBox::getSurfaceArea() const {
+	Vec3Df extent = this->max - this->min;
+
+	// An empty box has a negative extent
+	if (extent[0] < 0.0f || extent[1] < 0.0f || extent[2] < 0.0f)
+		return 0.0f;
+
+	return 2.0f * (extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0]);
+}
+
 void BoundingBox::includePoint(const Vec3Df &point) {
 	// Find the new minimum bound
 	this->min[0] = std::min<float>(this->min[0], point[0]);
@@ -66,4 +96,16 @@ void BoundingBox::includePoint(const Vec3Df &point) {
 	this->max[0] = std::max<float>(this->max[0], point[0]);
 	this->max[1] = std::max<float>(this->max[1], point[1]);
 	this->max[2] = std::max<float>(this->max[2], point[2]);
+}
+
+void BoundingBox::includeBoundingBox(const BoundingBox &box) {
+	// Find the new minimum bound
+	this->min[0] = std::min<float>(this->min[0], box.min[0]);
+	this->min[1] = std::min<float>(this->min[1], box.min[1]);
+	this->min[2] = std::min<float>(this->min[2], box.min[2]);
+
+	// Find the new maximum bound
+	this->max[0] = std::max<float>(this->max[0], box.max[0]);
+	this->max[1] = std::max<float>(this->max[1], box.max[1]);
+	this->max[2] = std::max<float>(this->max[2], box.max[2]);
 }
\ No newline at end of file
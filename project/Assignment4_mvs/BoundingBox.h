@@ -3,6 +3,8 @@
 
 #include "Vec3D.h"
 
+class Ray;
+
 class BoundingBox {
 public:
 	/**
@@ -18,22 +20,33 @@ public:
 	BoundingBox(const Vec3Df &min, const Vec3Df &max);
 
 	/**
-	 * Tests whether the given ray intersects the bounding box.
-	 * @param[in] origin The origin of the vector
-	 * @param[in] dir The direction of the vector
+	 * Tests whether the given ray intersects the bounding box within the ray's interval.
+	 * @param[in] ray The ray.
+	 * @return Returns true if the ray intersects the bounding box; otherwise false.
+	 */
+	bool intersects(const Ray &ray) const;
+
+	/**
+	 * Tests whether the given ray intersects the bounding box within the ray's interval and calculates
+	 * the distance at which the ray enters the bounding box.
+	 * @param[in] ray The ray.
+	 * @param[out] distance The distance at which the ray enters the bounding box, which is
+	 * at least the ray's minimum distance.
 	 * @return Returns true if the ray intersects the bounding box; otherwise false.
 	 */
-	bool intersects(const Vec3Df &origin, const Vec3Df &dir) const;
+	bool intersects(const Ray &ray, float &distance) const;
 
 	/**
-	 * Tests whether the given ray intersects the bounding box and calculates
-	 * the distance at which the intersection occurred.
-	 * @param[in] origin The origin of the vector
-	 * @param[in] dir The direction of the vector
-	 * @param[out] distance The distance at which the intersection occurred, if any.
+	 * Tests whether the given ray intersects the bounding box within the ray's interval and calculates
+	 * the distances at which the ray enters and leaves the bounding box.
+	 * @param[in] ray The ray.
+	 * @param[out] entryDistance The distance at which the ray enters the bounding box, which is
+	 * at least the ray's minimum distance.
+	 * @param[out] exitDistance The distance at which the ray leaves the bounding box, which is
+	 * at most the ray's maximum distance.
 	 * @return Returns true if the ray intersects the bounding box; otherwise false.
 	 */
-	bool intersects(const Vec3Df &origin, const Vec3Df &dir, float &distance) const;
+	bool intersects(const Ray &ray, float &entryDistance, float &exitDistance) const;
 
 	/**
 	 * Tests whether this bounding box intersects with the given bounding box.
@@ -42,18 +55,43 @@ public:
 	 */
 	bool intersects(const BoundingBox &other) const;
 
+	/**
+	 * Tests whether this bounding box fully contains the given bounding box.
+	 * @param[in] other A bounding box.
+	 * @return True if the given bounding box lies inside this bounding box; otherwise false.
+	 */
+	bool contains(const BoundingBox &other) const;
+
+	/**
+	 * Tests whether the bounding box is empty, in which case it does not contain any point.
+	 * @return True if the bounding box is empty; otherwise false.
+	 */
+	bool isEmpty() const;
+
 	/**
 	 * Computes the center of the bounding box.
 	 * @return The center of the bounding box.
 	 */
 	Vec3Df getCenter() const;
 
+	/**
+	 * Computes the surface area of the bounding box.
+	 * @return The surface area of the bounding box, or zero if the box is empty.
+	 */
+	float getSurfaceArea() const;
+
 	/**
 	 * Grows the bounding box if needed so that it includes the given point.
 	 * @param[in] point The point to be occluded in the bounding box.
 	 */
 	void includePoint(const Vec3Df &point);
 
+	/**
+	 * Grows the bounding box if needed so that it includes the given bounding box.
+	 * @param[in] box The bounding box to be included in the bounding box.
+	 */
+	void includeBoundingBox(const BoundingBox &box);
+
 	/**
 	 * The minimum point contained by the bounding box.
 	 */
@@ -2,6 +2,7 @@
 
 #include "DiskGeometry.h"
 #include "Random.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 #include "SurfacePoint.h"
 
@@ -15,30 +16,49 @@ float DiskGeometry::getArea() const {
 	return Constants::Pi * this->radius * this->radius;
 }
 
-bool DiskGeometry::calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const {
-	bool result = PlaneGeometry::calculateClosestIntersection(origin, dir, intersection);
+bool DiskGeometry::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
+	// Intersect the plane first, without touching the parameters until the hit is known to lie on the disk
+	Ray planeRay = ray;
+	RayIntersection planeIntersection;
 
-	if (result) {
-		// Check if the hitPoint is inside the disk
-		return (intersection.hitPoint - this->center).getSquaredLength() <= (this->radius * this->radius);
-	}
+	if (!PlaneGeometry::calculateClosestIntersection(planeRay, planeIntersection))
+		return false;
 
-	return false;
+	// Check if the hitPoint is inside the disk
+	if ((planeIntersection.hitPoint - this->center).getSquaredLength() > (this->radius * this->radius))
+		return false;
+
+	intersection = planeIntersection;
+	ray.maxDistance = planeRay.maxDistance;
+
+	return true;
 }
 
 void DiskGeometry::getRandomSurfacePoint(SurfacePoint &surface) const {
+	// Generate two random numbers
+	float u, v;
+	Random::sampleUnitSquare(u, v);
+
+	this->sampleSurfacePoint(u, v, surface);
+}
+
+void DiskGeometry::sampleSurfacePoint(float u, float v, SurfacePoint &surface) const {
 	// Get two vectors orthogonal to the normal
-	Vec3Df u, v;
-	this->normal.getTwoOrthogonals(u, v);
+	Vec3Df tangent, bitangent;
+	this->normal.getTwoOrthogonals(tangent, bitangent);
 
-	// Generate two random numbers
+	// Map the point in the unit square to the unit disk, keeping stratified points stratified
 	float x, y;
-	Random::sampleUnitDisk(x, y);
+	Random::mapUnitDisk(u, v, x, y);
+
+	// The orthogonal vectors are not normalized
+	tangent.normalize();
+	bitangent.normalize();
 
-	// Offset the center with the two orthogonal vectors scaled by the random numbers
-	Vec3Df point = this->center + x * u + y * v;
+	// Offset the center with the two orthogonal vectors scaled by the disk coordinates and the radius
+	Vec3Df point = this->center + (x * this->radius) * tangent + (y * this->radius) * bitangent;
 
-	surface.geometry = this->shared_from_this();
+	surface.geometry = this;
 	surface.normal = this->normal;
 	surface.point = point;
 	surface.texCoords = Vec2Df(x, y);
@@ -22,12 +22,11 @@ public:
 	/*
 	* Calculates whether the object is hit by the given ray and sets the intersection parameter
 	* to the RayIntersection representing the closest point of intersection.
-	* @param[in] origin The origin of the ray.
-	* @param[in] dir The direction of the ray.
+	* @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
 	* @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	* @return True if the ray intersected an object; otherwise false.
 	*/
-	bool calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const;
+	bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const;
 
 	/**
 	* Gets a random surface point on this geometry.
@@ -36,6 +35,14 @@ public:
 	*/
 	void getRandomSurfacePoint(SurfacePoint &surface) const;
 
+	/**
+	* Maps a point in the unit square to a surface point on the disk with the concentric mapping.
+	* @param u The u component of the point in the unit square.
+	* @param v The v component of the point in the unit square.
+	* @param[out] surface The surface point.
+	*/
+	void sampleSurfacePoint(float u, float v, SurfacePoint &surface) const;
+
 	/**
 	* Returns a bounding box that bounds this geometry.
 	*/
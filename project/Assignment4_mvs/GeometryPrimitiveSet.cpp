@@ -0,0 +1,48 @@
+#include <cassert>
+
+#include "GeometryPrimitiveSet.h"
+#include "IGeometry.h"
+#include "Ray.h"
+#include "RayIntersection.h"
+
+GeometryPrimitiveSet::GeometryPrimitiveSet(std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry)
+: geometry(geometry) {
+	assert(geometry);
+}
+
+std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> GeometryPrimitiveSet::getGeometry() const {
+	return this->geometry;
+}
+
+unsigned int GeometryPrimitiveSet::getPrimitiveCount() const {
+	return this->geometry->size();
+}
+
+BoundingBox GeometryPrimitiveSet::getBoundingBox(unsigned int index) const {
+	return (*this->geometry)[index]->getBoundingBox();
+}
+
+bool GeometryPrimitiveSet::calculateClosestIntersection(const unsigned int *indices, unsigned int count, Ray &ray, RayIntersection &intersection) const {
+	const std::vector<std::shared_ptr<IGeometry>> &geometry = *this->geometry;
+	bool intersectsAny = false;
+
+	for (unsigned int i = 0; i < count; i++) {
+		// The ray shrinks with every intersection, so the intersection is only updated by closer geometry
+		if (geometry[indices[i]]->calculateClosestIntersection(ray, intersection))
+			intersectsAny = true;
+	}
+
+	return intersectsAny;
+}
+
+bool GeometryPrimitiveSet::calculateAnyIntersection(const unsigned int *indices, unsigned int count, const Ray &ray, RayIntersection &intersection) const {
+	const std::vector<std::shared_ptr<IGeometry>> &geometry = *this->geometry;
+
+	for (unsigned int i = 0; i < count; i++) {
+		// If an intersection was found, return it
+		if (geometry[indices[i]]->calculateAnyIntersection(ray, intersection))
+			return true;
+	}
+
+	return false;
+}
\ No newline at end of file
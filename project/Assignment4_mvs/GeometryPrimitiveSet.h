@@ -0,0 +1,67 @@
+#ifndef GEOMETRYPRIMITIVESET_H
+#define GEOMETRYPRIMITIVESET_H
+
+#include <memory>
+#include <vector>
+
+#include "IPrimitiveSet.h"
+
+class IGeometry;
+
+/**
+ * Represents a vector of geometrical objects as a primitive set, each object being a primitive.
+ */
+class GeometryPrimitiveSet : public IPrimitiveSet {
+public:
+	/**
+	 * Initializes a GeometryPrimitiveSet with the given geometry.
+	 * @param[in] geometry Pointer to a vector containing the geometry.
+	 */
+	GeometryPrimitiveSet(std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry);
+
+	/**
+	 * Gets the vector containing the geometry.
+	 * @return Pointer to a vector containing the geometry.
+	 */
+	std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> getGeometry() const;
+
+	/**
+	 * Gets the number of primitives in the set.
+	 * @return The number of primitives in the set.
+	 */
+	unsigned int getPrimitiveCount() const;
+
+	/**
+	 * Returns a bounding box that bounds the primitive with the given index.
+	 * @param index The index of the primitive.
+	 * @return A bounding box that bounds the primitive, which is empty if the primitive is unbounded.
+	 */
+	BoundingBox getBoundingBox(unsigned int index) const;
+
+	/*
+	 * Intersects the given primitives with the ray and updates the intersection parameter
+	 * if any of them is hit within the ray's interval.
+	 * @param[in] indices The indices of the primitives to intersect.
+	 * @param count The number of primitives to intersect.
+	 * @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
+	 * @param[in,out] intersection Reference to a RayIntersection representing the closest intersection point of the ray.
+	 * @return True if the intersection was updated; otherwise false.
+	 */
+	bool calculateClosestIntersection(const unsigned int *indices, unsigned int count, Ray &ray, RayIntersection &intersection) const;
+
+	/*
+	 * Returns whether any of the given primitives is hit by the given ray and sets the intersection parameter
+	 * to the RayIntersection representing the point of intersection.
+	 * @param[in] indices The indices of the primitives to intersect.
+	 * @param count The number of primitives to intersect.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
+	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	 * @return True if the ray intersected a primitive; otherwise false.
+	 */
+	bool calculateAnyIntersection(const unsigned int *indices, unsigned int count, const Ray &ray, RayIntersection &intersection) const;
+
+private:
+	std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry;
+};
+
+#endif
\ No newline at end of file
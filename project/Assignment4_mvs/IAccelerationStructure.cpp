@@ -1,8 +1,10 @@
 #include <assert.h>
 #include <limits>
 
+#include "GeometryPrimitiveSet.h"
 #include "IAccelerationStructure.h"
 #include "IGeometry.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 
 IAccelerationStructure::~IAccelerationStructure() {
@@ -11,15 +13,21 @@ IAccelerationStructure::~IAccelerationStructure() {
 void IAccelerationStructure::preprocess() {
 }
 
-std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> IAccelerationStructure::getGeometry() const {
-	return this->geometry;
+const std::shared_ptr<const IPrimitiveSet> &IAccelerationStructure::getPrimitives() const {
+	return this->primitives;
+}
+
+void IAccelerationStructure::setPrimitives(std::shared_ptr<const IPrimitiveSet> primitives) {
+	this->primitives = primitives;
 }
 
 void IAccelerationStructure::setGeometry(std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry) {
-	this->geometry = geometry;
+	this->primitives = std::make_shared<GeometryPrimitiveSet>(geometry);
 }
 
-bool IAccelerationStructure::calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const {
-	// By default just use the regular intersection method
-	return this->calculateClosestIntersection(origin, dir, intersection);
+bool IAccelerationStructure::calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const {
+	// By default just use the regular intersection method on a copy of the ray
+	Ray closestRay = ray;
+
+	return this->calculateClosestIntersection(closestRay, intersection);
 }
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "Vec3D.h"
 
 class IGeometry;
+class IPrimitiveSet;
+class Ray;
 class RayIntersection;
 
 class IAccelerationStructure {
@@ -14,15 +16,21 @@ public:
 	virtual ~IAccelerationStructure();
 
 	/**
-	 * Gets the vector containing all geometry in this structure.
-	 * @return Pointer to a vector containing all the geometry in this structure.
+	 * Gets the primitives in this structure.
+	 * @return Pointer to the primitive set containing all primitives in this structure.
+	 * The pointer is returned by reference, so queries can reach the primitives without touching its reference count.
 	 */
-	std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> getGeometry() const;
+	const std::shared_ptr<const IPrimitiveSet> &getPrimitives() const;
 
 	/**
-	 * Sets the vector containing all geometry in this structure.
-	 * @param[in] accelerator Pointer to vector containing all the geometry in this structure
-	 * @return Pointer to the old geometry vector.
+	 * Sets the primitives in this structure.
+	 * @param[in] primitives Pointer to the primitive set containing all primitives in this structure.
+	 */
+	void setPrimitives(std::shared_ptr<const IPrimitiveSet> primitives);
+
+	/**
+	 * Sets the vector containing all geometry in this structure, each geometrical object being a primitive.
+	 * @param[in] geometry Pointer to vector containing all the geometry in this structure
 	 */
 	void setGeometry(std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry);
 
@@ -34,26 +42,24 @@ public:
 	/*
 	 * Returns whether any object is hit by the given ray and sets the intersection parameter
 	 * to the RayIntersection representing the closest point of intersection.
-	 * @param[in] origin The origin of the ray.
-	 * @param[in] dir The direction of the ray.
+	 * Only intersections within the ray's interval are accepted, if none is found neither parameter is modified.
+	 * @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
 	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	 * @return True if the ray intersected an object; otherwise false.
 	 */
-	virtual bool calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const = 0;
+	virtual bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const = 0;
 
 	/*
 	 * Returns whether any object is hit by the given ray and sets the intersection parameter
 	 * to the RayIntersection representing the point of intersection.
-	 * @param[in] origin The origin of the ray.
-	 * @param[in] dir The direction of the ray.
-	 * @param maxDistance The maximum distance at which the intersection may occur.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
 	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	 * @return True if the ray intersected an object; otherwise false.
 	 */
-	virtual bool calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const = 0;
+	virtual bool calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const = 0;
 
 private:
-	std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry;
+	std::shared_ptr<const IPrimitiveSet> primitives;
 };
 
 #endif
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include <cassert>
+#include <cmath>
 
 #include "IGeometry.h"
 #include "IMaterial.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 #include "SurfacePoint.h"
 
@@ -16,7 +18,7 @@ IGeometry::IGeometry(std::shared_ptr<const IMaterial> material) {
 IGeometry::~IGeometry() {
 }
 
-std::shared_ptr<const IMaterial> IGeometry::getMaterial() const {
+const std::shared_ptr<const IMaterial> &IGeometry::getMaterial() const {
 	return this->material;
 }
 
@@ -29,10 +31,33 @@ void IGeometry::setMaterial(std::shared_ptr<const IMaterial> material) {
 void IGeometry::preprocess() {
 }
 
-bool IGeometry::calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const {
-	// If no intersection was found or the closest intersection is beyond the maximum distance, return false; otherwise true.
-	if (!this->calculateClosestIntersection(origin, dir, intersection) || intersection.distance > maxDistance)
-		return false;
-	else
-		return true;
+bool IGeometry::calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const {
+	// The closest intersection shrinks the ray, so find it on a copy.
+	// Any intersection it finds lies within the ray's interval.
+	Ray closestRay = ray;
+
+	return this->calculateClosestIntersection(closestRay, intersection);
+}
+
+void IGeometry::sampleSurfacePoint(float, float, SurfacePoint &surface) const {
+	this->getRandomSurfacePoint(surface);
+}
+
+float IGeometry::sampleSolidAngle(const Vec3Df &point, float u, float v, SurfacePoint &surface) const {
+	this->sampleSurfacePoint(u, v, surface);
+
+	return this->getSolidAngleDensity(point, surface);
+}
+
+float IGeometry::getSolidAngleDensity(const Vec3Df &point, const SurfacePoint &surface) const {
+	Vec3Df lightVector = point - surface.point;
+	float distance = lightVector.normalize();
+	float cosTheta = fabsf(Vec3Df::dotProduct(surface.normal, lightVector));
+
+	// A surface seen edge-on covers no solid angle
+	if (cosTheta <= 0.0f)
+		return 0.0f;
+
+	// Points are sampled uniformly by area, convert the density to solid angle
+	return distance * distance / (this->getArea() * cosTheta);
 }
\ No newline at end of file
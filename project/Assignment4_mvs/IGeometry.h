@@ -7,6 +7,7 @@
 #include "Vec3D.h"
 
 class IMaterial;
+class Ray;
 class RayIntersection;
 class SurfacePoint;
 
@@ -23,7 +24,7 @@ public:
 	 * Gets the material.
 	 * @return Pointer to an material.
 	 */
-	std::shared_ptr<const IMaterial> getMaterial() const;
+	const std::shared_ptr<const IMaterial> &getMaterial() const;
 
 	/**
 	 * Sets the material
@@ -45,23 +46,21 @@ public:
 	/*
 	 * Calculates whether the object is hit by the given ray and sets the intersection parameter
 	 * to the RayIntersection representing the closest point of intersection.
-	 * @param[in] origin The origin of the ray.
-	 * @param[in] dir The direction of the ray.
+	 * Only intersections within the ray's interval are accepted, if none is found neither parameter is modified.
+	 * @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
 	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	 * @return True if the ray intersected an object; otherwise false.
 	 */
-	virtual bool calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const = 0;
+	virtual bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const = 0;
 
 	/*
 	 * Returns whether the object is hit by the given ray and sets the intersection parameter
 	 * to the RayIntersection representing the point of intersection.
-	 * @param[in] origin The origin of the ray.
-	 * @param[in] dir The direction of the ray.
-	 * @param maxDistance The maximum distance at which the intersection may occur.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
 	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	 * @return True if the ray intersected an object; otherwise false.
 	 */
-	virtual bool calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const;
+	virtual bool calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const;
 
 	/**
 	 * Gets the surface point on this geometry at the given intersection point.
@@ -77,6 +76,37 @@ public:
 	 */
 	virtual void getRandomSurfacePoint(SurfacePoint &surface) const = 0;
 
+	/**
+	 * Maps a point in the unit square to a surface point on this geometry, such that uniformly distributed
+	 * points in the square give surface points uniformly distributed by area and stratified points remain stratified.
+	 * The default implementation ignores the point in the square and gets a random surface point.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] surface The surface point.
+	 */
+	virtual void sampleSurfacePoint(float u, float v, SurfacePoint &surface) const;
+
+	/**
+	 * Maps a point in the unit square to a surface point on this geometry as seen from the given point
+	 * and calculates the probability density of the surface point per unit solid angle.
+	 * The default implementation samples the surface uniformly by area with sampleSurfacePoint.
+	 * @param[in] point The point from which the geometry is seen.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] surface The surface point.
+	 * @return The probability density of the surface point per unit solid angle, or zero if it cannot be seen from the point.
+	 */
+	virtual float sampleSolidAngle(const Vec3Df &point, float u, float v, SurfacePoint &surface) const;
+
+	/**
+	 * Calculates the probability density per unit solid angle with which sampleSolidAngle
+	 * samples the given surface point as seen from the given point.
+	 * @param[in] point The point from which the geometry is seen.
+	 * @param[in] surface A surface point on this geometry.
+	 * @return The probability density of the surface point per unit solid angle, or zero if it cannot be seen from the point.
+	 */
+	virtual float getSolidAngleDensity(const Vec3Df &point, const SurfacePoint &surface) const;
+
 	/**
 	 * Returns a bounding box that bounds this geometry.
 	 */
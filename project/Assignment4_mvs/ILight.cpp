@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include "IGeometry.h"
 #include "ILight.h"
@@ -17,7 +19,18 @@ float ILight::getArea() const {
 		return 1.0f;
 }
 
-std::shared_ptr<IGeometry> ILight::getGeometry() const {
+BoundingBox ILight::getBoundingBox() const {
+	if (this->geometry)
+		return this->geometry->getBoundingBox();
+	else
+		return BoundingBox();
+}
+
+float ILight::getPower() const {
+	return this->intensity * this->getArea();
+}
+
+const std::shared_ptr<IGeometry> &ILight::getGeometry() const {
 	return this->geometry;
 }
 
@@ -25,6 +38,13 @@ float ILight::getFalloff() const {
 	return this->falloff;
 }
 
+float ILight::getRange() const {
+	if (this->falloff <= 0.0f)
+		return std::numeric_limits<float>::infinity();
+
+	return 1.0f / sqrtf(this->falloff);
+}
+
 float ILight::getIntensity() const {
 	return this->intensity;
 }
@@ -44,6 +64,25 @@ void ILight::setIntensity(float intensity) {
 void ILight::preprocess() {
 }
 
+bool ILight::sampleLight(const Vec3Df &point, Vec3Df &lightPoint, Vec3Df &lightColor, float &density) const {
+	// The light is not hit by rays, so there is no density to weigh the sample against
+	density = 0.0f;
+
+	return this->sampleLight(point, lightPoint, lightColor);
+}
+
+bool ILight::sampleLight(const Vec3Df &point, float, float, Vec3Df &lightPoint, Vec3Df &lightColor) const {
+	return this->sampleLight(point, lightPoint, lightColor);
+}
+
+bool ILight::sampleLight(const Vec3Df &point, float, float, Vec3Df &lightPoint, Vec3Df &lightColor, float &density) const {
+	return this->sampleLight(point, lightPoint, lightColor, density);
+}
+
+bool ILight::evaluateLight(const Vec3Df &, const SurfacePoint &, Vec3Df &, float &) const {
+	return false;
+}
+
 float ILight::calculateAttenuation(float distance) const {
 	// Calculate the intensity falloff over distance
 	float attenuation = 1.0f - this->falloff * distance * distance;
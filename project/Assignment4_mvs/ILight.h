@@ -3,9 +3,11 @@
 
 #include <memory>
 
+#include "BoundingBox.h"
 #include "Vec3D.h"
 
 class IGeometry;
+class SurfacePoint;
 
 /**
  * Represents a light source.
@@ -21,11 +23,23 @@ public:
 	*/
 	float getArea() const;
 	
+	/**
+	 * Gets the bounding box of the light, used to estimate its contribution to points in the scene.
+	 * @return The bounding box of the geometry associated with this light, or an empty box if there is none.
+	 */
+	virtual BoundingBox getBoundingBox() const;
+
+	/**
+	 * Gets an estimate of the total amount of light emitted by the light, used to choose between lights.
+	 * @return The intensity of the light multiplied by its area.
+	 */
+	virtual float getPower() const;
+
 	/**
 	 * Gets the geometry associated with this light, this can be null.
 	 * @return The geometry associated with this light, this can be null.
 	 */
-	std::shared_ptr<IGeometry> getGeometry() const;
+	const std::shared_ptr<IGeometry> &getGeometry() const;
 
 	/**
 	 * Gets the falloff factor which determines how much the light dimishes over distance.
@@ -36,6 +50,13 @@ public:
 	 */
 	float getFalloff() const;
 
+	/**
+	 * Gets the distance beyond which the attenuation, and thus the light, becomes zero.
+	 * The attenuation is 1 - falloff * distance^2, so this is 1 / sqrt(falloff).
+	 * @return The range of the light, or infinity if the light has no falloff.
+	 */
+	float getRange() const;
+
 	/**
 	 * Gets the intensity of the light.
 	 * The range for this parameter is [0, ->), where 0 means the light is completely black and
@@ -84,6 +105,57 @@ public:
 	 */
 	virtual bool sampleLight(const Vec3Df &point, Vec3Df &lightPoint, Vec3Df &lightColor) const = 0;
 
+	/**
+	 * Samples the light like sampleLight and calculates the probability density per unit solid angle
+	 * with which the light point is chosen, as seen from the given point.
+	 * Lights without geometry cannot be hit by a ray and report a density of zero.
+	 * @param[in] point A point in the scene.
+	 * @param[out] lightPoint A point on the light source.
+	 * @param[out] lightColor The light emitted along the outgoing vector.
+	 * @param[out] density The probability density of the light point per unit solid angle, or zero for lights without geometry.
+	 * @return Returns true if the point is visible from the light source; otherwise false.
+	 */
+	virtual bool sampleLight(const Vec3Df &point, Vec3Df &lightPoint, Vec3Df &lightColor, float &density) const;
+
+	/**
+	 * Samples the light like sampleLight, choosing the light point from the given point in the unit square
+	 * so that stratified points in the square give stratified light points.
+	 * Lights without geometry ignore the point in the square.
+	 * @param[in] point A point in the scene.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] lightPoint A point on the light source.
+	 * @param[out] lightColor The light emitted along the outgoing vector.
+	 * @return Returns true if the point is visible from the light source; otherwise false.
+	 */
+	virtual bool sampleLight(const Vec3Df &point, float u, float v, Vec3Df &lightPoint, Vec3Df &lightColor) const;
+
+	/**
+	 * Samples the light like sampleLight with a density, choosing the light point from the given point in the unit square
+	 * so that stratified points in the square give stratified light points.
+	 * Lights without geometry ignore the point in the square.
+	 * @param[in] point A point in the scene.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] lightPoint A point on the light source.
+	 * @param[out] lightColor The light emitted along the outgoing vector.
+	 * @param[out] density The probability density of the light point per unit solid angle, or zero for lights without geometry.
+	 * @return Returns true if the point is visible from the light source; otherwise false.
+	 */
+	virtual bool sampleLight(const Vec3Df &point, float u, float v, Vec3Df &lightPoint, Vec3Df &lightColor, float &density) const;
+
+	/**
+	 * Calculates the light emitted from a point on the geometry of the light towards the given point,
+	 * for instance one found by a ray hitting the light, and the probability density per unit solid angle
+	 * with which sampleLight chooses this light point.
+	 * @param[in] point A point in the scene.
+	 * @param[in] lightSurface A point on the geometry of the light.
+	 * @param[out] lightColor The light emitted towards the point.
+	 * @param[out] density The probability density of the light point per unit solid angle.
+	 * @return Returns true if the light point emits towards the point; otherwise false.
+	 */
+	virtual bool evaluateLight(const Vec3Df &point, const SurfacePoint &lightSurface, Vec3Df &lightColor, float &density) const;
+
 protected:
 	/**
 	 * Calculates the amount of attenuation over distance from the falloff factor.
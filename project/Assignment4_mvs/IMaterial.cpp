@@ -7,10 +7,12 @@
 #include "Constants.h"
 #include "ConstantTexture.h"
 #include "IMaterial.h"
+#include "IrradianceCache.h"
 #include "IRayTracer.h"
 #include "ITexture.h"
 #include "mesh.h"
 #include "Random.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 #include "Scene.h"
 #include "SurfacePoint.h"
@@ -169,25 +171,60 @@ Vec3Df IMaterial::ambientLight(const SurfacePoint &surface, const Scene *scene)
 		return Vec3Df();
 	}
 
-	// Start with no ambient occlusion
-	float occlusionFactor = 1.0f;
+	// Scale the ambient light by the fraction that is not occluded
+	float visibility = IMaterial::calculateAmbientVisibility(surface, scene);
 
+	return this->sampleColor(surface.texCoords) * this->ambientReflectance * scene->getAmbientLight() * visibility;
+}
+
+float IMaterial::calculateAmbientVisibility(const SurfacePoint &surface, const Scene *scene) {
 	// Get the number of occlusion samples to be taken
 	int samples = scene->getAmbientOcclusionSamples();
 
+	if (samples <= 0)
+		return 1.0f;
+
+	// Interpolate the occlusion from nearby points if possible
+	IrradianceCache *cache = scene->getAmbientOcclusionCacheEnabled() ? scene->getAmbientOcclusionCache().get() : nullptr;
+	Vec3Df cachedVisibility;
+
+	if (cache && cache->interpolate(surface.point, surface.normal, cachedVisibility))
+		return cachedVisibility[0];
+
+	float radius = scene->getAmbientOcclusionRadius();
+	int unoccludedSamples = 0;
+	float inverseDistanceSum = 0.0f;
+
 	// For each sample...
 	for (int i = 0; i < samples; i++) {
-		// Get a random vector in the hemisphere defined by the surface normal
-		Vec3Df dir = Random::sampleHemisphere(surface.normal);
+		// Get a cosine weighted random vector in the hemisphere defined by the surface normal,
+		// so the fraction of unoccluded samples weighs directions like a diffuse surface does
+		Vec3Df dir = Random::sampleCosineHemisphere(surface.normal);
+		Ray ray(surface.point + dir * Constants::Epsilon, dir, 0.0f, radius);
 		RayIntersection intersection;
 
-		// If there is any geometry in this direction, occlude it
-		if (scene->calculateAnyIntersection(surface.point + dir * Constants::Epsilon, dir, std::numeric_limits<float>::infinity(), intersection)) {
-			occlusionFactor -= 1.0f / samples;
+		// Any geometry within the radius occludes the sample. A record in the cache
+		// needs the distance to the closest geometry, otherwise any geometry will do.
+		bool isOccluded = cache ?
+			scene->calculateClosestIntersection(ray, intersection) :
+			scene->calculateAnyIntersection(ray, intersection);
+
+		if (isOccluded) {
+			inverseDistanceSum += 1.0f / std::max(intersection.distance, Constants::Epsilon);
+		}
+		else {
+			inverseDistanceSum += 1.0f / radius;
+			unoccludedSamples++;
 		}
 	}
 
-	return this->sampleColor(surface.texCoords) * this->ambientReflectance * scene->getAmbientLight() * occlusionFactor;
+	float visibility = unoccludedSamples / (float)samples;
+
+	// Remember the occlusion with the harmonic mean distance to the surrounding geometry, which bounds how quickly it changes
+	if (cache)
+		cache->insert(surface.point, surface.normal, samples / inverseDistanceSum, Vec3Df(visibility, visibility, visibility));
+
+	return visibility;
 }
 
 Vec3Df IMaterial::emittedLight(const SurfacePoint &surface, const Vec3Df &reflectedVector) const {
@@ -210,89 +247,174 @@ Vec3Df IMaterial::reflectedLight(const SurfacePoint &surface, const Vec3Df &inco
 	return result;
 }
 
+Vec3Df IMaterial::diffuseLight(const SurfacePoint &surface, const Vec3Df &reflectedVector, const Vec3Df &irradiance) const {
+	if (!this->diffuseBrdf) {
+		return Vec3Df();
+	}
+
+	return this->diffuseReflectance * this->diffuseBrdf->reflectance(surface.normal, reflectedVector, surface.normal, surface.texCoords, irradiance);
+}
+
+bool IMaterial::isDiffuse() const {
+	return this->diffuseBrdf && this->diffuseReflectance > 0.0f && (!this->specularBrdf || this->specularReflectance <= 0.0f);
+}
+
+Vec3Df IMaterial::sampleIncomingVector(const SurfacePoint &surface, const Vec3Df &reflectedVector) const {
+	float diffuseWeight = this->diffuseBrdf ? this->diffuseReflectance : 0.0f;
+	float specularWeight = this->specularBrdf ? this->specularReflectance : 0.0f;
+
+	// Always draw the number choosing the BRDF, so the same random dimensions are used for every material
+	float choice = Random::randUnit() * (diffuseWeight + specularWeight);
+
+	if (specularWeight > 0.0f && choice >= diffuseWeight) {
+		return this->specularBrdf->sampleIncomingVector(reflectedVector, surface.normal);
+	}
+	else if (diffuseWeight > 0.0f) {
+		return this->diffuseBrdf->sampleIncomingVector(reflectedVector, surface.normal);
+	}
+
+	// Without any BRDF there is nothing to follow, sample the cosine-weighted hemisphere
+	return Random::sampleCosineHemisphere(surface.normal);
+}
+
+float IMaterial::getProbabilityDensity(const SurfacePoint &surface, const Vec3Df &incomingVector, const Vec3Df &reflectedVector) const {
+	float diffuseWeight = this->diffuseBrdf ? this->diffuseReflectance : 0.0f;
+	float specularWeight = this->specularBrdf ? this->specularReflectance : 0.0f;
+	float totalWeight = diffuseWeight + specularWeight;
+
+	if (totalWeight <= 0.0f) {
+		return std::max(0.0f, Vec3Df::dotProduct(incomingVector, surface.normal)) / Constants::Pi;
+	}
+
+	// The density of the mixture of the BRDFs
+	float density = 0.0f;
+
+	if (diffuseWeight > 0.0f) {
+		density += diffuseWeight * this->diffuseBrdf->getProbabilityDensity(incomingVector, reflectedVector, surface.normal);
+	}
+
+	if (specularWeight > 0.0f) {
+		density += specularWeight * this->specularBrdf->getProbabilityDensity(incomingVector, reflectedVector, surface.normal);
+	}
+
+	return density / totalWeight;
+}
+
 Vec3Df IMaterial::specularLight(
 	const SurfacePoint &surface, 
 	const Vec3Df &reflectedVector,
 	const Scene *scene,
 	int iteration) const
 {
-	// If the material is transparent...
-	if (this->specularBrdf == nullptr && this->specularReflectance > 0.0f) {
-		Vec3Df incomingVector = reflectedVector;
+	Vec3Df direction;
+	Vec3Df weight;
 
-		// Calculate the reflected vector
-		Vec3Df reflectedVector = IMaterial::calculateReflectionVector(incomingVector, surface.normal);
+	if (!this->calculateSpecularRay(surface, reflectedVector, direction, weight)) {
+		return Vec3Df();
+	}
 
-		if (reflectedVector.getSquaredLength() == 0.0f) {
-			return Vec3Df();
-		}
+	// Trace the reflection ray
+	float distance;
+	Vec3Df reflected = scene->getRayTracer()->performRayTracingIteration(
+		surface.point + direction * Constants::Epsilon,
+		direction,
+		iteration + 1,
+		distance);
 
-		// Trace the reflection ray
-		float distance;
-		Vec3Df reflected = scene->getRayTracer()->performRayTracingIteration(
-			surface.point + reflectedVector * Constants::Epsilon,
-			reflectedVector,
-			iteration + 1,
-			distance);
+	return weight * reflected;
+}
 
-		// Calculate the reflectance
-		Vec3Df reflectance = this->sampleColor(surface.texCoords);
+Vec3Df IMaterial::transmittedLight(
+	const SurfacePoint &surface,
+	const Vec3Df &reflectedVector,
+	const Scene *scene,
+	int iteration) const
+{
+	Vec3Df direction;
+	Vec3Df weight;
+	Vec3Df absorbance;
 
-		return this->specularReflectance * reflected * reflectance;
-	}
-	else {
+	if (!this->calculateTransmittedRay(surface, reflectedVector, direction, weight, absorbance)) {
 		return Vec3Df();
 	}
+
+	float distance;
+
+	// Trace the refraction ray
+	Vec3Df transmitted = scene->getRayTracer()->performRayTracingIteration(
+		surface.point + direction * Constants::Epsilon,
+		direction,
+		iteration + 1,
+		distance);
+
+	// Absorbance using beer's law
+	absorbance *= -distance;
+	absorbance[0] = expf(absorbance[0]);
+	absorbance[1] = expf(absorbance[1]);
+	absorbance[2] = expf(absorbance[2]);
+
+	return weight * transmitted * absorbance;
 }
 
-Vec3Df IMaterial::transmittedLight(
+bool IMaterial::calculateSpecularRay(
 	const SurfacePoint &surface,
 	const Vec3Df &reflectedVector,
-	const Scene *scene,
-	int iteration) const
+	Vec3Df &direction,
+	Vec3Df &weight) const
 {
-	// If the material is transparent...
-	if (this->transparency > 0.0f) {
-		Vec3Df incomingVector = reflectedVector;
-		float n1, n2;
-
-		// Get the refractive indices	
-		if (surface.isInside) {
-			n1 = this->refractiveIndex;
-			n2 = Constants::AirRefractiveIndex;
-		}
-		else {
-			n1 = Constants::AirRefractiveIndex;
-			n2 = this->refractiveIndex;
-		}
+	// Only materials without a specular BRDF act as a perfect mirror
+	if (this->specularBrdf != nullptr || this->specularReflectance <= 0.0f) {
+		return false;
+	}
 
-		// Sample the reflected vector, reflectance, refracted vector and transmittance
-		Vec3Df refractedVector = IMaterial::calculateRefractedVector(incomingVector, surface.normal, n1, n2);
+	// Calculate the reflected vector
+	direction = IMaterial::calculateReflectionVector(reflectedVector, surface.normal);
 
-		if (refractedVector.getSquaredLength() == 0.0f) {
-			return Vec3Df();
-		}
+	if (direction.getSquaredLength() == 0.0f) {
+		return false;
+	}
+
+	// Calculate the reflectance
+	weight = this->specularReflectance * this->sampleColor(surface.texCoords);
 
-		float distance;
+	return true;
+}
 
-		// Trace the refraction ray
-		Vec3Df transmitted = scene->getRayTracer()->performRayTracingIteration(
-			surface.point + refractedVector * Constants::Epsilon,
-			refractedVector,
-			iteration + 1,
-			distance);
+bool IMaterial::calculateTransmittedRay(
+	const SurfacePoint &surface,
+	const Vec3Df &reflectedVector,
+	Vec3Df &direction,
+	Vec3Df &weight,
+	Vec3Df &absorbance) const
+{
+	// If the material is not transparent no light is transmitted
+	if (this->transparency <= 0.0f) {
+		return false;
+	}
 
-		// Absorbance using beer's law
-		Vec3Df absorbance = this->sampleColor(surface.texCoords) * this->absorbance * -distance;
-		absorbance[0] = expf(absorbance[0]);
-		absorbance[1] = expf(absorbance[1]);
-		absorbance[2] = expf(absorbance[2]);
+	float n1, n2;
 
-		return this->transparency * transmitted * absorbance;
+	// Get the refractive indices	
+	if (surface.isInside) {
+		n1 = this->refractiveIndex;
+		n2 = Constants::AirRefractiveIndex;
 	}
 	else {
-		return Vec3Df();
+		n1 = Constants::AirRefractiveIndex;
+		n2 = this->refractiveIndex;
 	}
+
+	// Calculate the refracted vector, which is empty in case of total internal reflection
+	direction = IMaterial::calculateRefractedVector(reflectedVector, surface.normal, n1, n2);
+
+	if (direction.getSquaredLength() == 0.0f) {
+		return false;
+	}
+
+	weight = Vec3Df(this->transparency, this->transparency, this->transparency);
+	absorbance = this->sampleColor(surface.texCoords) * this->absorbance;
+
+	return true;
 }
 
 Vec3Df IMaterial::calculateReflectionVector(
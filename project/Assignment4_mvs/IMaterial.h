@@ -158,7 +158,8 @@ public:
 	}
 
 	/**
-	 * Calculates the amount of ambient light hitting the surface.
+	 * Calculates the amount of ambient light hitting the surface, which is reduced by the geometry around it
+	 * if the scene takes ambient occlusion samples.
 	 * This is not physically correct.
 	 * @param[in] surface The surface for which to perform the calculations.
 	 * @param[in] scene The scene.
@@ -184,6 +185,41 @@ public:
 	 */
 	Vec3Df reflectedLight(const SurfacePoint &surface, const Vec3Df &incomingVector, const Vec3Df &reflectedVector, const Vec3Df &lightColor) const;
 
+	/**
+	 * Calculates the light diffusely reflected towards the given vector when the surface receives the given irradiance,
+	 * as if all of it arrived along the normal. This is exact for Lambertian BRDFs, which do not depend on the incoming vector.
+	 * @param[in] surface The surface for which to perform the calculations.
+	 * @param[in] reflectedVector The vector that the light is reflected towards.
+	 * @param[in] irradiance The irradiance of the surface.
+	 * @return The light diffusely reflected towards the given vector.
+	 */
+	Vec3Df diffuseLight(const SurfacePoint &surface, const Vec3Df &reflectedVector, const Vec3Df &irradiance) const;
+
+	/**
+	 * Gets whether this material reflects light only through its diffuse BRDF, in which case
+	 * the light it reflects can be computed from the irradiance of the surface.
+	 * @return True if the material has a diffuse BRDF and no specular BRDF; otherwise false.
+	 */
+	bool isDiffuse() const;
+
+	/**
+	 * Samples an incoming vector for the BRDFs of this material, choosing between the diffuse and specular BRDF
+	 * in proportion to their reflectance.
+	 * @param[in] surface The surface for which to perform the calculations.
+	 * @param[in] reflectedVector The vector that the light is reflected towards.
+	 * @return The sampled incoming vector, which may lie below the surface.
+	 */
+	Vec3Df sampleIncomingVector(const SurfacePoint &surface, const Vec3Df &reflectedVector) const;
+
+	/**
+	 * Calculates the probability density per unit solid angle with which sampleIncomingVector returns the given incoming vector.
+	 * @param[in] surface The surface for which to perform the calculations.
+	 * @param[in] incomingVector The vector from which the light is comming.
+	 * @param[in] reflectedVector The vector that the light is reflected towards.
+	 * @return The probability density of the incoming vector.
+	 */
+	float getProbabilityDensity(const SurfacePoint &surface, const Vec3Df &incomingVector, const Vec3Df &reflectedVector) const;
+
 	/**
 	 * Calculates the specularly reflected light towards the given vector.
 	 * @param[in] surface The surface for which to perform the calculations.
@@ -212,7 +248,46 @@ public:
 		const Scene *scene,
 		int iteration) const;
 
+	/**
+	 * Calculates the ray along which specularLight traces the light that is specularly reflected towards the given vector.
+	 * @param[in] surface The surface for which to perform the calculations.
+	 * @param[in] reflectedVector The vector that the light is reflected towards.
+	 * @param[out] direction The direction of the specular ray.
+	 * @param[out] weight The fraction of the light along the specular ray that is reflected towards the given vector.
+	 * @return True if the material reflects light specularly towards the given vector; otherwise false.
+	 */
+	bool calculateSpecularRay(
+		const SurfacePoint &surface,
+		const Vec3Df &reflectedVector,
+		Vec3Df &direction,
+		Vec3Df &weight) const;
+
+	/**
+	 * Calculates the ray along which transmittedLight traces the light that is transmitted towards the given vector.
+	 * @param[in] surface The surface for which to perform the calculations.
+	 * @param[in] reflectedVector The vector that the light is reflected towards.
+	 * @param[out] direction The direction of the refracted ray.
+	 * @param[out] weight The fraction of the light along the refracted ray that is transmitted, not accounting for absorption.
+	 * @param[out] absorbance The absorbance per unit of distance along the refracted ray in the Beer-Lambert law.
+	 * @return True if the material transmits light towards the given vector; otherwise false.
+	 */
+	bool calculateTransmittedRay(
+		const SurfacePoint &surface,
+		const Vec3Df &reflectedVector,
+		Vec3Df &direction,
+		Vec3Df &weight,
+		Vec3Df &absorbance) const;
+
 private:
+	/**
+	* Calculates the fraction of the ambient light that reaches the surface, by tracing cosine weighted rays
+	* up to the ambient occlusion radius of the scene or by interpolating it from the scene's cache.
+	* @param[in] surface The surface for which to perform the calculations.
+	* @param[in] scene The scene.
+	* @return The fraction of the ambient light that is not occluded.
+	*/
+	static float calculateAmbientVisibility(const SurfacePoint &surface, const Scene *scene);
+
 	/**
 	* Calculates the reflection vector.
 	* @param[in] incomingVector The vector in the direction that the light is coming from.
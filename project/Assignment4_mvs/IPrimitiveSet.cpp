@@ -0,0 +1,4 @@
+#include "IPrimitiveSet.h"
+
+IPrimitiveSet::~IPrimitiveSet() {
+}
\ No newline at end of file
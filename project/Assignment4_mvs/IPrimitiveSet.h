@@ -0,0 +1,54 @@
+#ifndef IPRIMITIVESET_H
+#define IPRIMITIVESET_H
+
+#include "BoundingBox.h"
+#include "Vec3D.h"
+
+class Ray;
+class RayIntersection;
+
+/**
+ * Represents a set of primitives which are referred to by their index.
+ * Acceleration structures are built over a primitive set and only store primitive indices.
+ */
+class IPrimitiveSet {
+public:
+	virtual ~IPrimitiveSet();
+
+	/**
+	 * Gets the number of primitives in the set.
+	 * @return The number of primitives in the set.
+	 */
+	virtual unsigned int getPrimitiveCount() const = 0;
+
+	/**
+	 * Returns a bounding box that bounds the primitive with the given index.
+	 * @param index The index of the primitive.
+	 * @return A bounding box that bounds the primitive, which is empty if the primitive is unbounded.
+	 */
+	virtual BoundingBox getBoundingBox(unsigned int index) const = 0;
+
+	/*
+	 * Intersects the given primitives with the ray and updates the intersection parameter
+	 * if any of them is hit within the ray's interval.
+	 * @param[in] indices The indices of the primitives to intersect.
+	 * @param count The number of primitives to intersect.
+	 * @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
+	 * @param[in,out] intersection Reference to a RayIntersection representing the closest intersection point of the ray.
+	 * @return True if the intersection was updated; otherwise false.
+	 */
+	virtual bool calculateClosestIntersection(const unsigned int *indices, unsigned int count, Ray &ray, RayIntersection &intersection) const = 0;
+
+	/*
+	 * Returns whether any of the given primitives is hit by the given ray and sets the intersection parameter
+	 * to the RayIntersection representing the point of intersection.
+	 * @param[in] indices The indices of the primitives to intersect.
+	 * @param count The number of primitives to intersect.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
+	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	 * @return True if the ray intersected a primitive; otherwise false.
+	 */
+	virtual bool calculateAnyIntersection(const unsigned int *indices, unsigned int count, const Ray &ray, RayIntersection &intersection) const = 0;
+};
+
+#endif
\ No newline at end of file
@@ -1,8 +1,18 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 #include "Constants.h"
+#include "ILight.h"
 #include "IRayTracer.h"
+#include "IrradianceCache.h"
+#include "LightTree.h"
+#include "Random.h"
+#include "RayIntersection.h"
 #include "Scene.h"
+#include "SurfacePoint.h"
 
 const Scene *IRayTracer::getScene() const {
 	// Return the scene pointer
@@ -18,4 +28,264 @@ Vec3Df IRayTracer::performRayTracing(const Vec3Df &origin, const Vec3Df &dir) co
 	float distance;
 
 	return this->performRayTracingIteration(origin, dir, 0, distance);
+}
+
+Vec3Df IRayTracer::calculateDirectLight(const RayIntersection &intersection, const SurfacePoint &surface) const {
+	// Sums the light reflected from every chosen light as it is chosen
+	class DirectLightVisitor : public LightVisitor {
+	public:
+		DirectLightVisitor(const IRayTracer *rayTracer, const RayIntersection &intersection, const SurfacePoint &surface) :
+		intersection(intersection),
+		lighting(Vec3Df()),
+		rayTracer(rayTracer),
+		surface(surface) {
+		}
+
+		void visitLight(const ILight *light, float weight) {
+			this->lighting += this->rayTracer->calculateLightContribution(this->intersection, this->surface, light) * weight;
+		}
+
+		const RayIntersection &intersection;
+		Vec3Df lighting;
+		const IRayTracer *rayTracer;
+		const SurfacePoint &surface;
+	};
+
+	DirectLightVisitor visitor(this, intersection, surface);
+	this->chooseLights(surface.point, visitor);
+
+	return visitor.lighting;
+}
+
+Vec3Df IRayTracer::calculateLightContribution(const RayIntersection &intersection, const SurfacePoint &surface, const ILight *light) const {
+	// Get a pointer to the scene.
+	const Scene *scene = this->getScene();
+
+	// The 'view' vector is the opposite of the ray direction
+	Vec3Df viewVector = -intersection.direction;
+	Vec3Df lightPoint;
+	Vec3Df lightColor;
+	Vec3Df lightVector;
+	Vec3Df lightContribution = Vec3Df();
+
+	// If the light is associated with the geometry we are trying to 
+	if (light->getGeometry().get() == intersection.geometry)
+		return lightContribution;
+
+	int lightSamples = this->getLightSampleCount(light);
+
+	// Only probe the visibility of lights that take more samples than there are probes
+	int probeCount = scene->getShadowProbeCount();
+	bool isProbing = probeCount > 0 && probeCount < lightSamples;
+	bool testShadows = true;
+	int visibleProbes = 0;
+	int occludedProbes = 0;
+
+	// The samples of the light are stratified, so the probes are spread over the light as well
+	unsigned int lightSeed = Random::rand();
+
+	for (int i = 0; i < lightSamples; i++) {
+		// Once all probes have been traced decide whether the point lies in the penumbra
+		if (isProbing && i == probeCount) {
+			// All probes were occluded, the point is fully shadowed
+			if (visibleProbes == 0 && occludedProbes > 0)
+				break;
+
+			// All probes reached the light, the point is fully lit. Probes for which the light could not be
+			// sampled tell nothing, so without a visible probe every sample is still tested
+			if (visibleProbes > 0 && occludedProbes == 0)
+				testShadows = false;
+		}
+
+		// Sample the light for a position and color
+		float u, v;
+		Random::sampleStratifiedSquare(i, lightSeed, u, v);
+
+		if (!light->sampleLight(surface.point, u, v, lightPoint, lightColor))
+			continue;
+
+		// Compute the vector from the intersection towards the light
+		lightVector = (lightPoint - surface.point);
+		float lightDistance = lightVector.normalize();
+
+		if (testShadows) {
+			// If the segment between the light and intersection intersects any geometry
+			// then the intersection is in shadow, continue to the next sample.
+			if (this->isShadowed(surface.point, lightVector, lightDistance)) {
+				occludedProbes++;
+				continue;
+			}
+
+			visibleProbes++;
+		}
+
+		// Evaluate the BRDF, essentially
+		lightContribution += surface.reflectedLight(lightVector, viewVector, lightColor);
+	}
+
+	return lightContribution / (float)lightSamples;
+}
+
+void IRayTracer::chooseLights(const Vec3Df &point, LightVisitor &visitor) const {
+	const Scene *scene = this->getScene();
+	const LightTree *lightTree = scene->getLightTree().get();
+	int count = scene->getSampledLightCount();
+
+	// Without sampling the light hierarchy every light reaching the point is sampled once
+	if (count <= 0) {
+		// Passes the lights reaching the point on to the visitor as they are found
+		struct ReachingLightVisitor {
+			LightVisitor &visitor;
+
+			void operator()(const ILight *light) {
+				this->visitor.visitLight(light, 1.0f);
+			}
+		};
+
+		ReachingLightVisitor reachingLightVisitor = { visitor };
+		lightTree->findLights(point, reachingLightVisitor);
+
+		return;
+	}
+
+	if (lightTree->isEmpty())
+		return;
+
+	// Choose lights in proportion to their estimated contribution, always drawing the same random numbers
+	for (int i = 0; i < count; i++) {
+		float probability;
+		const ILight *light = lightTree->chooseLight(point, Random::randUnit(), probability);
+
+		// Only lights that do not reach the point can have a zero probability
+		if (probability > 0.0f)
+			visitor.visitLight(light, 1.0f / (count * probability));
+	}
+}
+
+Vec3Df IRayTracer::calculateIrradiance(const SurfacePoint &surface, int iteration) const {
+	// Get a pointer to the scene.
+	const Scene *scene = this->getScene();
+	IrradianceCache *cache = scene->getIrradianceCache().get();
+	Vec3Df irradiance = Vec3Df();
+
+	if (cache->interpolate(surface.point, surface.normal, irradiance))
+		return irradiance;
+
+	// Divide the hemisphere into rings of equal projected solid angle and those into sectors,
+	// with about pi times as many sectors as rings so the cells are roughly square (Ward and Heckbert)
+	int samples = scene->getIrradianceSamples();
+	int rings = std::max(1, (int)(sqrtf(samples / Constants::Pi) + 0.5f));
+	int sectors = std::max(1, samples / rings);
+
+	// Get a right-handed frame around the normal
+	Vec3Df tangent, bitangent;
+	surface.normal.getTwoOrthogonals(tangent, bitangent);
+	tangent.normalize();
+	bitangent = Vec3Df::crossProduct(surface.normal, tangent);
+
+	// Trace an indirect path through a random direction in every cell, with a density proportional to the cosine
+	std::vector<Vec3Df> radiances(rings * sectors);
+	std::vector<float> distances(rings * sectors);
+	float inverseDistanceSum = 0.0f;
+
+	for (int k = 0; k < sectors; k++) {
+		for (int j = 0; j < rings; j++) {
+			float sinTheta = sqrtf((j + Random::randUnit()) / rings);
+			float cosTheta = sqrtf(std::max(0.0f, 1.0f - sinTheta * sinTheta));
+			float phi = Constants::TwoPi * (k + Random::randUnit()) / sectors;
+			Vec3Df dir = sinTheta * cosf(phi) * tangent + sinTheta * sinf(phi) * bitangent + cosTheta * surface.normal;
+
+			float distance = std::numeric_limits<float>::infinity();
+			radiances[j * sectors + k] = this->traceIndirectRay(surface.point + dir * Constants::Epsilon, dir, iteration, distance);
+			distances[j * sectors + k] = distance;
+
+			irradiance += radiances[j * sectors + k];
+			inverseDistanceSum += 1.0f / distance;
+		}
+	}
+
+	irradiance *= Constants::Pi / (rings * sectors);
+
+	// Estimate the gradients from the differences between neighbouring cells
+	Vec3Df rotationGradients[3];
+	Vec3Df translationGradients[3];
+
+	for (int k = 0; k < sectors; k++) {
+		int previousK = (k + sectors - 1) % sectors;
+
+		// The direction through the center of the sector, and the directions perpendicular
+		// to it and to the boundary with the previous sector, in the plane of the surface
+		float phi = Constants::TwoPi * (k + 0.5f) / sectors;
+		float boundaryPhi = Constants::TwoPi * k / sectors;
+		Vec3Df sectorVector = cosf(phi) * tangent + sinf(phi) * bitangent;
+		Vec3Df perpendicularVector = -sinf(phi) * tangent + cosf(phi) * bitangent;
+		Vec3Df boundaryVector = -sinf(boundaryPhi) * tangent + cosf(boundaryPhi) * bitangent;
+
+		Vec3Df rotationSum = Vec3Df();
+		Vec3Df ringSum = Vec3Df();
+		Vec3Df sectorSum = Vec3Df();
+
+		for (int j = 0; j < rings; j++) {
+			const Vec3Df &radiance = radiances[j * sectors + k];
+
+			// The tangent of jittered angles is unbounded near the horizon, use the center of the ring
+			float centerSinTheta2 = (j + 0.5f) / rings;
+			rotationSum += sqrtf(centerSinTheta2 / (1.0f - centerSinTheta2)) * radiance;
+
+			// The change in the light through the boundary with the previous sector, as seen from the closer surface
+			float sinThetaMin = sqrtf(j / (float)rings);
+			float sinThetaMax = sqrtf((j + 1) / (float)rings);
+			float sectorDistance = std::min(distances[j * sectors + k], distances[j * sectors + previousK]);
+
+			sectorSum += (sinThetaMax - sinThetaMin) / sectorDistance * (radiance - radiances[j * sectors + previousK]);
+
+			// The change in the light through the boundary with the previous ring
+			if (j > 0) {
+				float ringDistance = std::min(distances[j * sectors + k], distances[(j - 1) * sectors + k]);
+
+				ringSum += sinThetaMin * (1.0f - sinThetaMin * sinThetaMin) / ringDistance * (radiance - radiances[(j - 1) * sectors + k]);
+			}
+		}
+
+		for (int channel = 0; channel < 3; channel++) {
+			rotationGradients[channel] += perpendicularVector * (rotationSum[channel] * Constants::Pi / (rings * sectors));
+			translationGradients[channel] += sectorVector * (ringSum[channel] * Constants::TwoPi / sectors) + boundaryVector * sectorSum[channel];
+		}
+	}
+
+	// Remember the irradiance with the harmonic mean distance to the surrounding geometry, which bounds how quickly it changes
+	cache->insert(surface.point, surface.normal, (rings * sectors) / inverseDistanceSum, irradiance, rotationGradients, translationGradients);
+
+	return irradiance;
+}
+
+float IRayTracer::calculateLightChoiceRate(const ILight *light, const Vec3Df &point) const {
+	const Scene *scene = this->getScene();
+
+	if (scene->getSampledLightCount() <= 0)
+		return 1.0f;
+
+	return scene->getSampledLightCount() * scene->getLightTree()->getProbability(light, point);
+}
+
+int IRayTracer::getLightSampleCount(const ILight *light) const {
+	// Calculate the number of light samples to be taken based of the light's area
+	return (int)std::max(1.0f, light->getArea() * this->getScene()->getLightSampleDensity());
+}
+
+bool IRayTracer::isShadowed(const Vec3Df &point, const Vec3Df &lightVector, float lightDistance) const {
+	// Needed for the shadow intersection test but can be ignored.
+	RayIntersection shadowIntersection;
+
+	// The length of the shadow ray segment, this is slightly smaller
+	// than the actual distance between the object and light to
+	// prevent intersecting the object and lightsource themselves.
+	float segmentLength = lightDistance - 2.0f * Constants::Epsilon;
+
+	// If the light and object are extremely close then the segment length may become negative,
+	// only check shadows if there is enough room between the object and light.
+	if (segmentLength <= 0.0f)
+		return false;
+
+	return this->getScene()->calculateAnyIntersection(point + lightVector * Constants::Epsilon, lightVector, segmentLength, shadowIntersection);
 }
\ No newline at end of file
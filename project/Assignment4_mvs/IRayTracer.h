@@ -5,7 +5,10 @@
 
 #include "Vec3D.h"
 
+class ILight;
+class RayIntersection;
 class Scene;
+class SurfacePoint;
 
 /**
  * Represents a ray tracer.
@@ -56,7 +59,104 @@ public:
 		int iteration, 
 		float &distance) const = 0;
 
+protected:
+	/**
+	 * Calculates the light reflected towards the ray from the point of intersection that arrives directly
+	 * from the light sources, by sampling each light and testing whether the samples are in shadow.
+	 *
+	 * @param[in] intersection	The intersection point to shade.
+	 * @param[in] surface		The surface point at the intersection.
+	 * @return The light reflected directly from the light sources towards the ray.
+	 */
+	Vec3Df calculateDirectLight(const RayIntersection &intersection, const SurfacePoint &surface) const;
+
+	/**
+	 * Receives the lights chosen by chooseLights one at a time, so that they do not need to be stored.
+	 */
+	class LightVisitor {
+	public:
+		virtual ~LightVisitor(){};
+
+		/**
+		 * Visits a chosen light.
+		 *
+		 * @param[in] light	The chosen light.
+		 * @param weight		The factor by which the contribution of the light is to be multiplied,
+		 *					which is the reciprocal of the expected number of times it is chosen.
+		 */
+		virtual void visitLight(const ILight *light, float weight) = 0;
+	};
+
+	/**
+	 * Chooses the lights to be sampled at the given point. These are the lights whose range reaches the point,
+	 * or the lights chosen from the light hierarchy if the scene enables it.
+	 *
+	 * @param[in] point		The point being shaded.
+	 * @param[in] visitor	The visitor that is passed every chosen light, a light chosen more than once is passed as often.
+	 */
+	void chooseLights(const Vec3Df &point, LightVisitor &visitor) const;
+
+	/**
+	 * Calculates the expected number of times chooseLights chooses the given light at the given point over all choices.
+	 *
+	 * @param[in] light		The light.
+	 * @param[in] point		The point being shaded.
+	 * @return The expected number of times the light is chosen.
+	 */
+	float calculateLightChoiceRate(const ILight *light, const Vec3Df &point) const;
+
+	/**
+	 * Gets the number of samples taken of the given light at every surface, based on the area of the light
+	 * and the light sample density of the scene.
+	 *
+	 * @param[in] light		The light.
+	 * @return The number of samples taken of the light, which is at least one.
+	 */
+	int getLightSampleCount(const ILight *light) const;
+
+	/**
+	 * Tests whether any geometry blocks the light travelling from a point on a light to the given point.
+	 *
+	 * @param[in] point			The point being shaded.
+	 * @param[in] lightVector	The normalized vector from the point towards the light.
+	 * @param lightDistance		The distance from the point to the point on the light.
+	 * @return True if the point is in shadow; otherwise false.
+	 */
+	bool isShadowed(const Vec3Df &point, const Vec3Df &lightVector, float lightDistance) const;
+
+	/**
+	 * Calculates the irradiance from indirect light at the given diffuse surface, by interpolating it from the irradiance cache
+	 * or, if no record is valid at the surface, by tracing a hemisphere of indirect rays and adding the result as a new record.
+	 *
+	 * @param[in] surface	The surface point.
+	 * @param iteration		The current iteration.
+	 * @return The irradiance from indirect light.
+	 */
+	Vec3Df calculateIrradiance(const SurfacePoint &surface, int iteration) const;
+
+	/**
+	 * Traces one of the indirect rays from a surface whose irradiance is being calculated.
+	 *
+	 * @param[in] origin	The origin of the ray.
+	 * @param[in] dir		The direction of the ray.
+	 * @param[in] iteration	The iteration of the surface the ray leaves.
+	 * @param[out] distance	The distance to the closest surface hit by the ray, which is left unchanged if there is none.
+	 * @return The light towards the given ray.
+	 */
+	virtual Vec3Df traceIndirectRay(const Vec3Df &origin, const Vec3Df &dir, int iteration, float &distance) const = 0;
+
 private:
+	/**
+	 * Calculates the light reflected towards the ray from the point of intersection that arrives directly
+	 * from the given light, by sampling the light and testing whether the samples are in shadow.
+	 *
+	 * @param[in] intersection	The intersection point to shade.
+	 * @param[in] surface		The surface point at the intersection.
+	 * @param[in] light			The light.
+	 * @return The light reflected directly from the light towards the ray.
+	 */
+	Vec3Df calculateLightContribution(const RayIntersection &intersection, const SurfacePoint &surface, const ILight *light) const;
+
 	const Scene *scene;
 };
 
@@ -0,0 +1,4 @@
+#include "ISampler.h"
+
+ISampler::~ISampler() {
+}
\ No newline at end of file
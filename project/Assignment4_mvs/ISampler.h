@@ -0,0 +1,26 @@
+#ifndef ISAMPLER_H
+#define ISAMPLER_H
+
+/**
+ * Represents a sampler, which generates the random numbers used to render a pixel.
+ *
+ * A sampler is indexed by the pixel, the index of the sample within the pixel and the dimension,
+ * which is the index of the random number within the sample. The renderers start each sample with
+ * Random::startSample, after which the camera, lights, materials and ray tracers draw consecutive dimensions.
+ */
+class ISampler {
+public:
+	virtual ~ISampler();
+
+	/**
+	 * Gets the given dimension of a sample of the given pixel.
+	 * @param x The x-coordinate of the pixel.
+	 * @param y The y-coordinate of the pixel.
+	 * @param sampleIndex The index of the sample within the pixel.
+	 * @param dimension The index of the random number within the sample.
+	 * @return An unsigned integer in the range [0, UINT_MAX], which maps to [0, 1) when divided by 2^32.
+	 */
+	virtual unsigned int getSample(int x, int y, unsigned int sampleIndex, unsigned int dimension) const = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "IrradianceCache.h"
+
+const float IrradianceCache::DefaultErrorThreshold = 0.3f;
+
+// The harmonic mean distance of a record is clamped relative to the size of the bounds,
+// so records in corners do not become arbitrarily small and those in the open not arbitrarily large
+static const float MinDistanceFraction = 0.005f;
+static const float MaxDistanceFraction = 0.25f;
+
+IrradianceCache::Node::Node() {
+	for (int i = 0; i < 8; i++)
+		this->children[i].store(nullptr, std::memory_order_relaxed);
+
+	this->entries.store(nullptr, std::memory_order_relaxed);
+}
+
+IrradianceCache::Node::~Node() {
+	for (int i = 0; i < 8; i++)
+		delete this->children[i].load(std::memory_order_relaxed);
+
+	Entry *entry = this->entries.load(std::memory_order_relaxed);
+
+	while (entry) {
+		Entry *next = entry->next;
+		delete entry;
+		entry = next;
+	}
+}
+
+IrradianceCache::IrradianceCache()
+: errorThreshold(DefaultErrorThreshold),
+minDistance(0.0f),
+maxDistance(0.0f),
+root(new Node()),
+records(nullptr),
+recordCount(0) {
+}
+
+IrradianceCache::~IrradianceCache() {
+	this->clear(BoundingBox());
+
+	delete this->root;
+}
+
+float IrradianceCache::getErrorThreshold() const {
+	return this->errorThreshold;
+}
+
+void IrradianceCache::setErrorThreshold(float threshold) {
+	assert(threshold > 0.0f);
+
+	this->errorThreshold = threshold;
+}
+
+void IrradianceCache::clear(const BoundingBox &bounds) {
+	// Delete the octree along with the entries referring to the records
+	delete this->root;
+	this->root = new Node();
+
+	// Delete the records
+	Record *record = this->records.load(std::memory_order_relaxed);
+
+	while (record) {
+		Record *next = record->next;
+		delete record;
+		record = next;
+	}
+
+	this->records.store(nullptr, std::memory_order_relaxed);
+	this->recordCount.store(0, std::memory_order_relaxed);
+
+	// Divide a cube twice the size of the bounds, so the octants are cubes
+	// and records just outside the bounds, like on walls around the geometry, are still sorted
+	Vec3Df center = bounds.isEmpty() ? Vec3Df() : bounds.getCenter();
+	Vec3Df extent = bounds.isEmpty() ? Vec3Df(1.0f, 1.0f, 1.0f) : bounds.max - bounds.min;
+	float size = std::max(extent[0], std::max(extent[1], extent[2]));
+
+	if (size <= 0.0f)
+		size = 1.0f;
+
+	this->bounds = BoundingBox(center - Vec3Df(size, size, size), center + Vec3Df(size, size, size));
+	this->minDistance = MinDistanceFraction * extent.getLength();
+	this->maxDistance = MaxDistanceFraction * extent.getLength();
+
+	if (this->maxDistance <= 0.0f) {
+		this->minDistance = MinDistanceFraction * size;
+		this->maxDistance = MaxDistanceFraction * size;
+	}
+}
+
+int IrradianceCache::getRecordCount() const {
+	return this->recordCount.load(std::memory_order_relaxed);
+}
+
+bool IrradianceCache::interpolate(const Vec3Df &point, const Vec3Df &normal, Vec3Df &value) const {
+	Vec3Df valueSum = Vec3Df();
+	float weightSum = 0.0f;
+
+	// Every record valid at the point is stored in a node containing the point, visit those from the root down
+	const Node *node = this->root;
+	BoundingBox nodeBox = this->bounds;
+	bool isInside =
+		point[0] >= nodeBox.min[0] && point[1] >= nodeBox.min[1] && point[2] >= nodeBox.min[2] &&
+		point[0] <= nodeBox.max[0] && point[1] <= nodeBox.max[1] && point[2] <= nodeBox.max[2];
+
+	while (node) {
+		for (const Entry *entry = node->entries.load(std::memory_order_acquire); entry; entry = entry->next) {
+			const Record *record = entry->record;
+			Vec3Df offset = point - record->point;
+			float cosNormal = Vec3Df::dotProduct(normal, record->normal);
+
+			// Records on surfaces facing another way do not apply
+			if (cosNormal <= 0.0f)
+				continue;
+
+			// Records in front of the point may see surfaces that are hidden from it
+			if (Vec3Df::dotProduct(offset, normal + record->normal) < -0.1f * record->distance)
+				continue;
+
+			// The estimated error grows with the distance and the change of the normal
+			float error = offset.getLength() / record->distance + sqrtf(std::max(0.0f, 1.0f - cosNormal));
+
+			if (error >= this->errorThreshold)
+				continue;
+
+			// Extrapolate the value of the record to the point along its gradients
+			Vec3Df rotation = Vec3Df::crossProduct(record->normal, normal);
+			Vec3Df recordValue = record->value;
+
+			for (int channel = 0; channel < 3; channel++) {
+				recordValue[channel] +=
+					Vec3Df::dotProduct(rotation, record->rotationGradients[channel]) +
+					Vec3Df::dotProduct(offset, record->translationGradients[channel]);
+
+				recordValue[channel] = std::max(0.0f, recordValue[channel]);
+			}
+
+			// Let the weight fall off to zero at the threshold, so the interpolated values are continuous
+			float weight = 1.0f - error / this->errorThreshold;
+			valueSum += weight * recordValue;
+			weightSum += weight;
+		}
+
+		// Points outside the bounds only find the records stored in the root
+		if (!isInside)
+			break;
+
+		int octant = IrradianceCache::getOctant(nodeBox, point);
+		node = node->children[octant].load(std::memory_order_acquire);
+		nodeBox = IrradianceCache::getOctantBox(nodeBox, octant);
+	}
+
+	if (weightSum <= 0.0f)
+		return false;
+
+	value = valueSum / weightSum;
+
+	return true;
+}
+
+void IrradianceCache::insert(const Vec3Df &point, const Vec3Df &normal, float distance, const Vec3Df &value) {
+	// Records without gradients keep their value over the region where they are valid
+	Vec3Df gradients[3];
+
+	this->insert(point, normal, distance, value, gradients, gradients);
+}
+
+void IrradianceCache::insert(
+	const Vec3Df &point,
+	const Vec3Df &normal,
+	float distance,
+	const Vec3Df &value,
+	const Vec3Df rotationGradients[3],
+	const Vec3Df translationGradients[3])
+{
+	Record *record = new Record();
+	record->point = point;
+	record->normal = normal;
+	record->distance = std::max(this->minDistance, std::min(this->maxDistance, distance));
+	record->value = value;
+
+	// The gradients are estimated from few samples, limit the translational gradient
+	// so extrapolating over the region where the record is valid never more than doubles or clears a channel
+	float radius = this->errorThreshold * record->distance;
+
+	for (int channel = 0; channel < 3; channel++) {
+		float change = translationGradients[channel].getLength() * radius;
+		float scale = change > value[channel] ? std::max(0.0f, value[channel]) / change : 1.0f;
+
+		record->rotationGradients[channel] = rotationGradients[channel];
+		record->translationGradients[channel] = translationGradients[channel] * scale;
+	}
+
+	// Take ownership of the record
+	record->next = this->records.load(std::memory_order_relaxed);
+
+	while (!this->records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed)) {
+	}
+
+	this->recordCount.fetch_add(1, std::memory_order_relaxed);
+
+	// The record is valid up to where the error from the distance alone reaches the threshold
+	BoundingBox recordBox(point - Vec3Df(radius, radius, radius), point + Vec3Df(radius, radius, radius));
+
+	// Records reaching outside the bounds are stored in the root, which every lookup visits
+	if (!this->bounds.contains(recordBox)) {
+		IrradianceCache::addEntry(this->root, record);
+		return;
+	}
+
+	this->insert(this->root, this->bounds, record, recordBox, 0);
+}
+
+void IrradianceCache::insert(Node *node, const BoundingBox &nodeBox, const Record *record, const BoundingBox &recordBox, int depth) {
+	Vec3Df nodeExtent = nodeBox.max - nodeBox.min;
+	Vec3Df recordExtent = recordBox.max - recordBox.min;
+
+	// Store the record in nodes about the size of the region where it is valid
+	if (depth == MaxDepth || nodeExtent.getSquaredLength() < recordExtent.getSquaredLength()) {
+		IrradianceCache::addEntry(node, record);
+		return;
+	}
+
+	for (int octant = 0; octant < 8; octant++) {
+		BoundingBox octantBox = IrradianceCache::getOctantBox(nodeBox, octant);
+
+		if (!octantBox.intersects(recordBox))
+			continue;
+
+		// Create the child if it does not exist yet, if another thread was first use its child instead
+		Node *child = node->children[octant].load(std::memory_order_acquire);
+
+		if (!child) {
+			Node *newChild = new Node();
+
+			if (node->children[octant].compare_exchange_strong(child, newChild, std::memory_order_acq_rel, std::memory_order_acquire))
+				child = newChild;
+			else
+				delete newChild;
+		}
+
+		this->insert(child, octantBox, record, recordBox, depth + 1);
+	}
+}
+
+void IrradianceCache::addEntry(Node *node, const Record *record) {
+	Entry *entry = new Entry();
+	entry->record = record;
+	entry->next = node->entries.load(std::memory_order_relaxed);
+
+	// Publish the entry once it is complete, so lookups never see a partially written record
+	while (!node->entries.compare_exchange_weak(entry->next, entry, std::memory_order_release, std::memory_order_relaxed)) {
+	}
+}
+
+int IrradianceCache::getOctant(const BoundingBox &nodeBox, const Vec3Df &point) {
+	Vec3Df center = nodeBox.getCenter();
+
+	return (point[0] > center[0] ? 1 : 0) | (point[1] > center[1] ? 2 : 0) | (point[2] > center[2] ? 4 : 0);
+}
+
+BoundingBox IrradianceCache::getOctantBox(const BoundingBox &nodeBox, int octant) {
+	Vec3Df center = nodeBox.getCenter();
+	BoundingBox result = nodeBox;
+
+	for (int axis = 0; axis < 3; axis++) {
+		if (octant & (1 << axis))
+			result.min[axis] = center[axis];
+		else
+			result.max[axis] = center[axis];
+	}
+
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef IRRADIANCECACHE_H
+#define IRRADIANCECACHE_H
+
+#include <atomic>
+
+#include "BoundingBox.h"
+#include "Vec3D.h"
+
+/**
+ * Implements a cache of values which vary slowly over surfaces, like irradiance or ambient occlusion, after Ward et al.
+ *
+ * A record stores a value computed at a point along with the normal at that point and the harmonic mean distance
+ * to the surfaces seen from it. Values at nearby points are interpolated from the records whose estimated error is below
+ * a threshold, where the error grows with the distance relative to the harmonic mean distance and with the change of the normal.
+ * Records may store the gradients of the value with respect to rotating the normal and moving the point (Ward and Heckbert),
+ * with which every record extrapolates its value to the point being interpolated, so fewer records give smooth results.
+ * Records are found through an octree which stores every record in the nodes overlapping the region where it is valid.
+ *
+ * Records are inserted without locks, by linking them into the octree with compare-and-swap operations,
+ * so any number of threads can fill and use the cache at the same time. As the records depend on the order
+ * in which points are shaded, renders using the cache vary slightly with the number of threads.
+ */
+class IrradianceCache {
+public:
+	/**
+	 * The default maximum error of an interpolated value.
+	 */
+	static const float DefaultErrorThreshold;
+
+	/**
+	 * Initializes an empty cache with the default error threshold.
+	 */
+	IrradianceCache();
+	~IrradianceCache();
+
+	/**
+	 * Gets the maximum error of an interpolated value.
+	 * @return The maximum error of an interpolated value.
+	 */
+	float getErrorThreshold() const;
+
+	/**
+	 * Sets the maximum error of an interpolated value. Every record is valid up to the error threshold
+	 * times its harmonic mean distance, so smaller thresholds require more records.
+	 * @param threshold The maximum error of an interpolated value.
+	 */
+	void setErrorThreshold(float threshold);
+
+	/**
+	 * Removes all records, this is not thread safe.
+	 * @param[in] bounds The region in which most records are expected, for instance the bounds of the scene's geometry.
+	 * The octree divides a cube twice its size, and the harmonic mean distance of every record is clamped relative to its size.
+	 */
+	void clear(const BoundingBox &bounds);
+
+	/**
+	 * Gets the number of records in the cache.
+	 * @return The number of records in the cache.
+	 */
+	int getRecordCount() const;
+
+	/**
+	 * Interpolates the value at the given point from the records that are valid there.
+	 * @param[in] point The point.
+	 * @param[in] normal The surface normal at the point.
+	 * @param[out] value The interpolated value.
+	 * @return True if any record is valid at the point; otherwise false, in which case the value is not modified.
+	 */
+	bool interpolate(const Vec3Df &point, const Vec3Df &normal, Vec3Df &value) const;
+
+	/**
+	 * Adds a record to the cache.
+	 * @param[in] point The point at which the value was computed.
+	 * @param[in] normal The surface normal at the point.
+	 * @param distance The harmonic mean distance to the surfaces seen from the point, which may be infinite.
+	 * @param[in] value The value at the point.
+	 */
+	void insert(const Vec3Df &point, const Vec3Df &normal, float distance, const Vec3Df &value);
+
+	/**
+	 * Adds a record with gradients to the cache.
+	 * @param[in] point The point at which the value was computed.
+	 * @param[in] normal The surface normal at the point.
+	 * @param distance The harmonic mean distance to the surfaces seen from the point, which may be infinite.
+	 * @param[in] value The value at the point.
+	 * @param[in] rotationGradients For each channel of the value, its gradient with respect to the rotation of the normal,
+	 * so rotating the normal by a small vector r, around r, changes the channel by r dotted with its gradient.
+	 * @param[in] translationGradients For each channel of the value, its gradient with respect to moving the point.
+	 */
+	void insert(
+		const Vec3Df &point,
+		const Vec3Df &normal,
+		float distance,
+		const Vec3Df &value,
+		const Vec3Df rotationGradients[3],
+		const Vec3Df translationGradients[3]);
+
+private:
+	struct Record {
+		Vec3Df point;
+		Vec3Df normal;
+		float distance;
+		Vec3Df value;
+		Vec3Df rotationGradients[3];
+		Vec3Df translationGradients[3];
+		Record *next;
+	};
+
+	struct Entry {
+		const Record *record;
+		Entry *next;
+	};
+
+	struct Node {
+		Node();
+		~Node();
+
+		std::atomic<Node *> children[8];
+		std::atomic<Entry *> entries;
+	};
+
+	IrradianceCache(const IrradianceCache &other);
+	IrradianceCache &operator=(const IrradianceCache &other);
+
+	/**
+	 * Links the record into the given node or its descendants overlapping the region where the record is valid.
+	 */
+	void insert(Node *node, const BoundingBox &nodeBox, const Record *record, const BoundingBox &recordBox, int depth);
+
+	/**
+	 * Links the record into the list of the given node.
+	 */
+	static void addEntry(Node *node, const Record *record);
+
+	/**
+	 * Gets the octant of the given node that contains the given point.
+	 */
+	static int getOctant(const BoundingBox &nodeBox, const Vec3Df &point);
+
+	/**
+	 * Gets the bounding box of an octant of the given node.
+	 */
+	static BoundingBox getOctantBox(const BoundingBox &nodeBox, int octant);
+
+	static const int MaxDepth = 16;
+
+	float errorThreshold;
+	float minDistance;
+	float maxDistance;
+	BoundingBox bounds;
+	Node *root;
+	std::atomic<Record *> records;
+	std::atomic<int> recordCount;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,595 @@
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <math.h>
+#include <memory>
+#include <omp.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "LBVHAccelerator.h"
+
+// The maximum number of leaves of a treelet that is restructured
+static const int TreeletSize = 7;
+
+// The number of bits sorted in each pass of the radix sort
+static const int RadixBits = 8;
+static const int RadixSize = 1 << RadixBits;
+
+/**
+ * Counts the number of leading zero bits of a 64 bit integer.
+ */
+static int countLeadingZeros(unsigned long long value) {
+#ifdef _MSC_VER
+	unsigned long index;
+
+	return _BitScanReverse64(&index, value) ? 63 - (int)index : 64;
+#else
+	return value == 0 ? 64 : __builtin_clzll(value);
+#endif
+}
+
+/**
+ * Spreads the lower 21 bits of the given integer so that there are two zero bits between each bit.
+ */
+static unsigned long long expandBits(unsigned long long value) {
+	value &= 0x1fffff;
+	value = (value | value << 32) & 0x1f00000000ffffULL;
+	value = (value | value << 16) & 0x1f0000ff0000ffULL;
+	value = (value | value << 8) & 0x100f00f00f00f00fULL;
+	value = (value | value << 4) & 0x10c30c30c30c30c3ULL;
+	value = (value | value << 2) & 0x1249249249249249ULL;
+
+	return value;
+}
+
+/**
+ * Computes the length of the common prefix of the Morton codes at i and j, or -1 if j is out of range.
+ * Duplicate codes are made unique by appending the index of the primitive.
+ */
+static int commonPrefix(const unsigned long long *keys, int count, int i, int j) {
+	if (j < 0 || j >= count)
+		return -1;
+
+	if (keys[i] == keys[j])
+		return 64 + countLeadingZeros((unsigned long long)(i ^ j));
+
+	return countLeadingZeros(keys[i] ^ keys[j]);
+}
+
+LBVHAccelerator::LBVHAccelerator()
+: treeletOptimizationEnabled(true) {
+}
+
+bool LBVHAccelerator::getTreeletOptimizationEnabled() const {
+	return this->treeletOptimizationEnabled;
+}
+
+void LBVHAccelerator::setTreeletOptimizationEnabled(bool enabled) {
+	this->treeletOptimizationEnabled = enabled;
+}
+
+void LBVHAccelerator::buildHierarchy(std::vector<BuildPrimitive> &primitives) {
+	// A single primitive does not need sorting
+	if (primitives.size() < 2) {
+		BVHAccelerator::buildHierarchy(primitives);
+		return;
+	}
+
+	std::vector<unsigned long long> keys;
+	std::vector<RadixNode> radixNodes(2 * primitives.size() - 1);
+
+	LBVHAccelerator::sortPrimitives(primitives, keys);
+	LBVHAccelerator::emitHierarchy(keys, radixNodes);
+
+	this->refitHierarchy(primitives, radixNodes);
+
+	// The depth of the hierarchy is not bounded by the Morton codes alone,
+	// so fall back to the SAH builder in the rare case that it does not fit the traversal stack.
+	if (!this->flattenHierarchy(primitives, radixNodes)) {
+		this->nodes.clear();
+
+		BVHAccelerator::buildHierarchy(primitives);
+	}
+}
+
+void LBVHAccelerator::sortPrimitives(std::vector<BuildPrimitive> &primitives, std::vector<unsigned long long> &keys) {
+	int count = primitives.size();
+
+	// Compute the bounds of the centroids
+	BoundingBox centroidBounds;
+
+#pragma omp parallel
+	{
+		BoundingBox threadBounds;
+
+#pragma omp for
+		for (int i = 0; i < count; i++) {
+			threadBounds.includePoint(primitives[i].centroid);
+		}
+
+#pragma omp critical
+		centroidBounds.includeBoundingBox(threadBounds);
+	}
+
+	// Use 30 bit codes for small inputs and 63 bit codes when there are too many primitives
+	// to be separated by a grid of 1024 cells along each axis
+	int bitsPerAxis = count > (1 << 16) ? 21 : 10;
+	float cellCount = (float)(1 << bitsPerAxis);
+	Vec3Df extent = centroidBounds.max - centroidBounds.min;
+	Vec3Df scale;
+
+	for (int axis = 0; axis < 3; axis++) {
+		scale[axis] = extent[axis] > 0.0f ? cellCount / extent[axis] : 0.0f;
+	}
+
+	std::vector<unsigned int> values(count);
+	keys.resize(count);
+
+	// Compute the Morton code of each centroid
+#pragma omp parallel for
+	for (int i = 0; i < count; i++) {
+		unsigned long long key = 0;
+
+		for (int axis = 0; axis < 3; axis++) {
+			float cell = (primitives[i].centroid[axis] - centroidBounds.min[axis]) * scale[axis];
+
+			key |= expandBits((unsigned long long)std::min<float>(std::max<float>(cell, 0.0f), cellCount - 1.0f)) << (2 - axis);
+		}
+
+		keys[i] = key;
+		values[i] = i;
+	}
+
+	// Sort the codes with a least significant digit radix sort, each thread sorts a contiguous
+	// part of the input into the slots reserved for it in a shared histogram
+	int passCount = (3 * bitsPerAxis + RadixBits - 1) / RadixBits;
+	std::vector<unsigned long long> tempKeys(count);
+	std::vector<unsigned int> tempValues(count);
+	std::vector<unsigned int> histograms(omp_get_max_threads() * RadixSize);
+
+#pragma omp parallel
+	{
+		int thread = omp_get_thread_num();
+		int threadCount = omp_get_num_threads();
+		int begin = (int)((long long)count * thread / threadCount);
+		int end = (int)((long long)count * (thread + 1) / threadCount);
+		unsigned int *histogram = &histograms[thread * RadixSize];
+
+		for (int pass = 0; pass < passCount; pass++) {
+			int shift = pass * RadixBits;
+			const unsigned long long *sourceKeys = pass % 2 == 0 ? &keys[0] : &tempKeys[0];
+			const unsigned int *sourceValues = pass % 2 == 0 ? &values[0] : &tempValues[0];
+			unsigned long long *targetKeys = pass % 2 == 0 ? &tempKeys[0] : &keys[0];
+			unsigned int *targetValues = pass % 2 == 0 ? &tempValues[0] : &values[0];
+
+			// Count the digits in this thread's part of the input
+			std::fill(histogram, histogram + RadixSize, 0);
+
+			for (int i = begin; i < end; i++) {
+				histogram[(sourceKeys[i] >> shift) & (RadixSize - 1)]++;
+			}
+
+#pragma omp barrier
+#pragma omp single
+			{
+				unsigned int offset = 0;
+
+				// Turn the counts into offsets, ordered by digit and then by thread to keep the sort stable
+				for (int digit = 0; digit < RadixSize; digit++) {
+					for (int i = 0; i < threadCount; i++) {
+						unsigned int digitCount = histograms[i * RadixSize + digit];
+
+						histograms[i * RadixSize + digit] = offset;
+						offset += digitCount;
+					}
+				}
+			}
+
+			// Scatter this thread's part of the input
+			for (int i = begin; i < end; i++) {
+				unsigned int slot = histogram[(sourceKeys[i] >> shift) & (RadixSize - 1)]++;
+
+				targetKeys[slot] = sourceKeys[i];
+				targetValues[slot] = sourceValues[i];
+			}
+
+#pragma omp barrier
+		}
+	}
+
+	// After an odd number of passes the result is in the temporary buffers
+	if (passCount % 2 == 1) {
+		keys.swap(tempKeys);
+		values.swap(tempValues);
+	}
+
+	// Reorder the primitives
+	std::vector<BuildPrimitive> sortedPrimitives(count);
+
+#pragma omp parallel for
+	for (int i = 0; i < count; i++) {
+		sortedPrimitives[i] = primitives[values[i]];
+	}
+
+	primitives.swap(sortedPrimitives);
+}
+
+void LBVHAccelerator::emitHierarchy(const std::vector<unsigned long long> &keys, std::vector<RadixNode> &radixNodes) {
+	const unsigned long long *k = &keys[0];
+	int count = keys.size();
+	int leafBase = count - 1;
+
+	radixNodes[0].parent = -1;
+
+	// Each interior node finds the range of codes it covers and where that range is split
+	// independently of the other nodes. See "Maximizing Parallelism in the Construction of BVHs,
+	// Octrees, and k-d Trees" by Tero Karras.
+#pragma omp parallel for
+	for (int i = 0; i < count - 1; i++) {
+		// Determine the direction in which the range of the node extends
+		int direction = commonPrefix(k, count, i, i + 1) - commonPrefix(k, count, i, i - 1) > 0 ? 1 : -1;
+
+		// Find an upper bound for the length of the range
+		int minPrefix = commonPrefix(k, count, i, i - direction);
+		int maxLength = 2;
+
+		while (commonPrefix(k, count, i, i + maxLength * direction) > minPrefix) {
+			maxLength *= 2;
+		}
+
+		// Find the other end of the range using binary search
+		int length = 0;
+
+		for (int step = maxLength / 2; step >= 1; step /= 2) {
+			if (commonPrefix(k, count, i, i + (length + step) * direction) > minPrefix)
+				length += step;
+		}
+
+		int j = i + length * direction;
+
+		// Find the position of the highest differing bit within the range using binary search
+		int nodePrefix = commonPrefix(k, count, i, j);
+		int split = 0;
+		int step = length;
+
+		do {
+			step = (step + 1) / 2;
+
+			if (commonPrefix(k, count, i, i + (split + step) * direction) > nodePrefix)
+				split += step;
+		} while (step > 1);
+
+		int gamma = i + split * direction + std::min<int>(direction, 0);
+
+		// A child that covers a single code is a leaf
+		int left = std::min<int>(i, j) == gamma ? leafBase + gamma : gamma;
+		int right = std::max<int>(i, j) == gamma + 1 ? leafBase + gamma + 1 : gamma + 1;
+
+		radixNodes[i].left = left;
+		radixNodes[i].right = right;
+		radixNodes[left].parent = i;
+		radixNodes[right].parent = i;
+	}
+}
+
+void LBVHAccelerator::refitHierarchy(const std::vector<BuildPrimitive> &primitives, std::vector<RadixNode> &radixNodes) const {
+	int count = primitives.size();
+	int leafBase = count - 1;
+
+	// Counts the children of each interior node that have been processed
+	std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[count - 1]);
+
+#pragma omp parallel for
+	for (int i = 0; i < count - 1; i++) {
+		visits[i].store(0, std::memory_order_relaxed);
+	}
+
+	// Walk up from each leaf, the second child to arrive at a node processes it, so that
+	// a node is only processed once both of its subtrees are complete.
+#pragma omp parallel for
+	for (int i = 0; i < count; i++) {
+		RadixNode &leaf = radixNodes[leafBase + i];
+
+		leaf.boundingBox = primitives[i].boundingBox;
+		leaf.left = -1;
+		leaf.right = -1;
+		leaf.primitiveCount = 1;
+		leaf.nodeCount = 1;
+		leaf.cost = leaf.boundingBox.getSurfaceArea();
+		leaf.isLeaf = true;
+
+		int index = leaf.parent;
+
+		while (index >= 0 && visits[index].fetch_add(1, std::memory_order_acq_rel) == 1) {
+			this->updateNode(radixNodes, index);
+
+			// Small subtrees cannot form a full treelet and gain little from being restructured
+			if (this->treeletOptimizationEnabled && radixNodes[index].primitiveCount >= TreeletSize)
+				this->optimizeTreelet(radixNodes, index);
+
+			index = radixNodes[index].parent;
+		}
+	}
+}
+
+void LBVHAccelerator::optimizeTreelet(std::vector<RadixNode> &radixNodes, int root) const {
+	int leaves[TreeletSize];
+	int interiors[TreeletSize];
+	int leafCount = 2;
+	int interiorCount = 0;
+
+	leaves[0] = radixNodes[root].left;
+	leaves[1] = radixNodes[root].right;
+
+	// Grow the treelet by repeatedly expanding the leaf with the largest surface area
+	while (leafCount < TreeletSize) {
+		int best = -1;
+		float bestArea = -1.0f;
+
+		for (int i = 0; i < leafCount; i++) {
+			const RadixNode &node = radixNodes[leaves[i]];
+
+			if (node.left >= 0 && node.boundingBox.getSurfaceArea() > bestArea) {
+				best = i;
+				bestArea = node.boundingBox.getSurfaceArea();
+			}
+		}
+
+		if (best < 0)
+			break;
+
+		int expanded = leaves[best];
+
+		interiors[interiorCount++] = expanded;
+		leaves[best] = radixNodes[expanded].left;
+		leaves[leafCount++] = radixNodes[expanded].right;
+	}
+
+	// With two leaves there is only one possible treelet
+	if (leafCount < 3)
+		return;
+
+	int subsetCount = 1 << leafCount;
+	int full = subsetCount - 1;
+	float traversalCost = this->getTraversalCost();
+	unsigned int maxLeafSize = this->getMaxLeafSize();
+
+	BoundingBox boxes[1 << TreeletSize];
+	float areas[1 << TreeletSize];
+	float costs[1 << TreeletSize];
+	unsigned int primitiveCounts[1 << TreeletSize];
+	int partitions[1 << TreeletSize];
+
+	primitiveCounts[0] = 0;
+
+	// Find the optimal cost of every subset of the treelet leaves using dynamic programming,
+	// as in "Fast Parallel Construction of High-Quality Bounding Volume Hierarchies" by Karras and Aila.
+	for (int subset = 1; subset < subsetCount; subset++) {
+		// Extend the bounding box of the subset without its lowest leaf
+		int lowest = subset & -subset;
+		int rest = subset ^ lowest;
+		int leaf = 0;
+
+		while (lowest != 1 << leaf) {
+			leaf++;
+		}
+
+		boxes[subset] = boxes[rest];
+		boxes[subset].includeBoundingBox(radixNodes[leaves[leaf]].boundingBox);
+		primitiveCounts[subset] = primitiveCounts[rest] + radixNodes[leaves[leaf]].primitiveCount;
+		areas[subset] = boxes[subset].getSurfaceArea();
+
+		// A single leaf keeps its subtree and its cost
+		if (rest == 0) {
+			costs[subset] = radixNodes[leaves[leaf]].cost;
+			continue;
+		}
+
+		// Try every partition of the subset into two parts, each partition is only visited once
+		// by requiring the first part to contain the lowest leaf of the subset.
+		float bestCost = std::numeric_limits<float>::infinity();
+		int bestPartition = 0;
+
+		for (int part = (subset - 1) & subset; part > 0; part = (part - 1) & subset) {
+			if (!(part & lowest))
+				continue;
+
+			float cost = costs[part] + costs[subset ^ part];
+
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestPartition = part;
+			}
+		}
+
+		float splitCost = traversalCost * areas[subset] + bestCost;
+		float leafCost = primitiveCounts[subset] * areas[subset];
+
+		costs[subset] = primitiveCounts[subset] <= maxLeafSize ? std::min<float>(leafCost, splitCost) : splitCost;
+		partitions[subset] = bestPartition;
+	}
+
+	// Only restructure the treelet if that improves its cost
+	if (costs[full] >= radixNodes[root].cost)
+		return;
+
+	int stackNodes[TreeletSize];
+	int stackSubsets[TreeletSize];
+	int stackSize = 0;
+	int order[TreeletSize];
+	int orderSize = 0;
+	int freeInteriors = 0;
+
+	stackNodes[stackSize] = root;
+	stackSubsets[stackSize++] = full;
+
+	// Rebuild the treelet top-down, reusing its interior nodes
+	while (stackSize > 0) {
+		int index = stackNodes[--stackSize];
+		int subset = stackSubsets[stackSize];
+		int parts[2] = { partitions[subset], subset ^ partitions[subset] };
+		int children[2];
+
+		order[orderSize++] = index;
+
+		for (int side = 0; side < 2; side++) {
+			// A part with a single leaf refers to the leaf's subtree, larger parts need an interior node
+			if ((parts[side] & (parts[side] - 1)) == 0) {
+				for (int i = 0; i < leafCount; i++) {
+					if (parts[side] == 1 << i)
+						children[side] = leaves[i];
+				}
+			}
+			else {
+				children[side] = interiors[freeInteriors++];
+
+				stackNodes[stackSize] = children[side];
+				stackSubsets[stackSize++] = parts[side];
+			}
+
+			radixNodes[children[side]].parent = index;
+		}
+
+		radixNodes[index].left = children[0];
+		radixNodes[index].right = children[1];
+	}
+
+	// Update the interior nodes from the bottom up, children were visited after their parents
+	for (int i = orderSize - 1; i >= 0; i--) {
+		this->updateNode(radixNodes, order[i]);
+	}
+}
+
+void LBVHAccelerator::updateNode(std::vector<RadixNode> &radixNodes, int index) const {
+	RadixNode &node = radixNodes[index];
+	const RadixNode &left = radixNodes[node.left];
+	const RadixNode &right = radixNodes[node.right];
+
+	node.boundingBox = left.boundingBox;
+	node.boundingBox.includeBoundingBox(right.boundingBox);
+	node.primitiveCount = left.primitiveCount + right.primitiveCount;
+
+	float area = node.boundingBox.getSurfaceArea();
+	float splitCost = this->getTraversalCost() * area + left.cost + right.cost;
+	float leafCost = node.primitiveCount * area;
+
+	// Collapse the subtree into a single leaf if that is cheaper and the leaf is small enough
+	node.isLeaf = node.primitiveCount <= (unsigned int)this->getMaxLeafSize() && leafCost <= splitCost;
+	node.cost = node.isLeaf ? leafCost : splitCost;
+	node.nodeCount = node.isLeaf ? 1 : 1 + left.nodeCount + right.nodeCount;
+}
+
+bool LBVHAccelerator::flattenHierarchy(std::vector<BuildPrimitive> &primitives, const std::vector<RadixNode> &radixNodes) {
+	/**
+	 * A node of the radix tree together with its position in the node array and its first primitive.
+	 */
+	struct Entry {
+		int radixIndex;
+		unsigned int nodeIndex;
+		unsigned int primitiveOffset;
+	};
+
+	int leafBase = primitives.size() - 1;
+	std::vector<BuildPrimitive> orderedPrimitives(primitives.size());
+	std::vector<Entry> level(1);
+	std::vector<Entry> nextLevel;
+
+	level[0].radixIndex = 0;
+	level[0].nodeIndex = 0;
+	level[0].primitiveOffset = 0;
+
+	this->nodes.resize(radixNodes[0].nodeCount);
+
+	// Emit the nodes one level at a time. The subtree sizes tell where each node goes in the
+	// depth-first array, so all nodes of a level can be written in parallel.
+	for (int depth = 0; !level.empty(); depth++) {
+		if (depth > MaxDepth)
+			return false;
+
+		int levelSize = level.size();
+		nextLevel.resize(2 * levelSize);
+
+#pragma omp parallel for
+		for (int i = 0; i < levelSize; i++) {
+			const Entry &entry = level[i];
+			const RadixNode &radixNode = radixNodes[entry.radixIndex];
+			LinearNode &node = this->nodes[entry.nodeIndex];
+
+			node.boundingBox = radixNode.boundingBox;
+			node.padding = 0;
+
+			if (radixNode.isLeaf) {
+				node.offset = entry.primitiveOffset;
+				node.primitiveCount = (unsigned short)radixNode.primitiveCount;
+				node.axis = 0;
+
+				// Gather the primitives in the subtree, using the parent pointers instead of a stack
+				unsigned int offset = entry.primitiveOffset;
+				int current = entry.radixIndex;
+
+				while (radixNodes[current].left >= 0) {
+					current = radixNodes[current].left;
+				}
+
+				while (true) {
+					orderedPrimitives[offset++] = primitives[current - leafBase];
+
+					// Go up until we arrive from a left child, then descend into its sibling
+					while (current != entry.radixIndex && radixNodes[radixNodes[current].parent].right == current) {
+						current = radixNodes[current].parent;
+					}
+
+					if (current == entry.radixIndex)
+						break;
+
+					current = radixNodes[radixNodes[current].parent].right;
+
+					while (radixNodes[current].left >= 0) {
+						current = radixNodes[current].left;
+					}
+				}
+
+				nextLevel[2 * i].radixIndex = -1;
+				nextLevel[2 * i + 1].radixIndex = -1;
+			}
+			else {
+				int first = radixNode.left;
+				int second = radixNode.right;
+
+				// Traversal visits the first child first unless the ray points in the negative direction
+				// of the split axis, so order the children along the axis that separates them best.
+				Vec3Df offset = radixNodes[second].boundingBox.getCenter() - radixNodes[first].boundingBox.getCenter();
+				int axis = (fabs(offset[0]) >= fabs(offset[1]) && fabs(offset[0]) >= fabs(offset[2])) ? 0 : (fabs(offset[1]) >= fabs(offset[2]) ? 1 : 2);
+
+				if (offset[axis] < 0.0f)
+					std::swap(first, second);
+
+				node.offset = entry.nodeIndex + 1 + radixNodes[first].nodeCount;
+				node.primitiveCount = 0;
+				node.axis = (unsigned char)axis;
+
+				nextLevel[2 * i].radixIndex = first;
+				nextLevel[2 * i].nodeIndex = entry.nodeIndex + 1;
+				nextLevel[2 * i].primitiveOffset = entry.primitiveOffset;
+				nextLevel[2 * i + 1].radixIndex = second;
+				nextLevel[2 * i + 1].nodeIndex = node.offset;
+				nextLevel[2 * i + 1].primitiveOffset = entry.primitiveOffset + radixNodes[first].primitiveCount;
+			}
+		}
+
+		// Remove the slots of the leaves
+		level.clear();
+
+		for (std::vector<Entry>::const_iterator it = nextLevel.begin(); it != nextLevel.end(); ++it) {
+			if (it->radixIndex >= 0)
+				level.push_back(*it);
+		}
+	}
+
+	primitives.swap(orderedPrimitives);
+
+	return true;
+}
\ No newline at end of file
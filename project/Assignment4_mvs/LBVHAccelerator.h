@@ -0,0 +1,104 @@
+#ifndef LBVHACCELERATOR_H
+#define LBVHACCELERATOR_H
+
+#include <vector>
+
+#include "BVHAccelerator.h"
+
+/**
+ * Implements a linear bounding volume hierarchy (LBVH), which is built in parallel.
+ *
+ * The primitives are sorted along a Morton curve through their centroids using a parallel radix sort,
+ * after which every interior node of the hierarchy is emitted independently. Small treelets of the
+ * resulting hierarchy can optionally be restructured to minimize the surface area heuristic (SAH).
+ * The hierarchy is stored and traversed in the same way as by the BVHAccelerator.
+ */
+class LBVHAccelerator : public BVHAccelerator {
+public:
+	LBVHAccelerator();
+
+	/**
+	 * Gets whether the treelets of the hierarchy are restructured to minimize the SAH.
+	 * @return Whether the treelets of the hierarchy are restructured.
+	 */
+	bool getTreeletOptimizationEnabled() const;
+
+	/**
+	 * Sets whether the treelets of the hierarchy are restructured to minimize the SAH.
+	 * This makes the build slower, but improves the quality of the hierarchy.
+	 * @param enabled Whether the treelets of the hierarchy are restructured.
+	 */
+	void setTreeletOptimizationEnabled(bool enabled);
+
+protected:
+	/**
+	 * Builds the hierarchy for the given primitives and stores its nodes in depth-first order.
+	 * @param[in,out] primitives The primitives, reordered so that the primitives of each leaf are contiguous.
+	 */
+	void buildHierarchy(std::vector<BuildPrimitive> &primitives);
+
+private:
+	/**
+	 * A node of the binary radix tree. The first n - 1 nodes are interior nodes,
+	 * the remaining n nodes are leaves which each contain a single primitive.
+	 */
+	struct RadixNode {
+		BoundingBox boundingBox;
+		int left;
+		int right;
+		int parent;
+		unsigned int primitiveCount;
+		unsigned int nodeCount;
+		float cost;
+		bool isLeaf;
+	};
+
+	/**
+	 * Computes the Morton code of each primitive and sorts the primitives along the Morton curve.
+	 * @param[in,out] primitives The primitives to sort.
+	 * @param[out] keys The sorted Morton codes.
+	 */
+	static void sortPrimitives(std::vector<BuildPrimitive> &primitives, std::vector<unsigned long long> &keys);
+
+	/**
+	 * Emits the interior nodes of the binary radix tree over the sorted Morton codes.
+	 * @param[in] keys The sorted Morton codes.
+	 * @param[out] radixNodes The nodes of the binary radix tree.
+	 */
+	static void emitHierarchy(const std::vector<unsigned long long> &keys, std::vector<RadixNode> &radixNodes);
+
+	/**
+	 * Computes the bounding boxes and costs of the nodes from the leaves up,
+	 * and optionally restructures the treelet below each node.
+	 * @param[in] primitives The sorted primitives.
+	 * @param[in,out] radixNodes The nodes of the binary radix tree.
+	 */
+	void refitHierarchy(const std::vector<BuildPrimitive> &primitives, std::vector<RadixNode> &radixNodes) const;
+
+	/**
+	 * Restructures the treelet below the given node so that its SAH cost is minimal.
+	 * @param[in,out] radixNodes The nodes of the binary radix tree.
+	 * @param root The index of the root of the treelet.
+	 */
+	void optimizeTreelet(std::vector<RadixNode> &radixNodes, int root) const;
+
+	/**
+	 * Computes the bounding box, primitive count and cost of an interior node from its children.
+	 * @param[in,out] radixNodes The nodes of the binary radix tree.
+	 * @param index The index of the node.
+	 */
+	void updateNode(std::vector<RadixNode> &radixNodes, int index) const;
+
+	/**
+	 * Converts the binary radix tree into the depth-first node array,
+	 * collapsing subtrees into leaves where the SAH says so.
+	 * @param[in,out] primitives The sorted primitives, reordered so that the primitives of each leaf are contiguous.
+	 * @param[in] radixNodes The nodes of the binary radix tree.
+	 * @return True if the depth of the hierarchy fits the traversal stack; otherwise false.
+	 */
+	bool flattenHierarchy(std::vector<BuildPrimitive> &primitives, const std::vector<RadixNode> &radixNodes);
+
+	bool treeletOptimizationEnabled;
+};
+
+#endif
\ No newline at end of file
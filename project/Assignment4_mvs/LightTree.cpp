@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "ILight.h"
+#include "LightTree.h"
+
+LightTree::LightTree() {
+}
+
+void LightTree::build(const std::vector<std::shared_ptr<ILight>> &lights) {
+	this->nodes.clear();
+	this->leaves.clear();
+	this->geometryLights.clear();
+
+	if (lights.empty())
+		return;
+
+	const float inf = std::numeric_limits<float>::infinity();
+	const Vec3Df infinity(inf, inf, inf);
+
+	std::vector<int> indices(lights.size());
+	std::vector<Vec3Df> centers(lights.size());
+
+	// Create the leaves up front, the hierarchy is built on top of them
+	this->nodes.reserve(2 * lights.size() - 1);
+	this->nodes.resize(lights.size());
+
+	for (int i = 0; i < (int)lights.size(); i++) {
+		Node &leaf = this->nodes[i];
+
+		leaf.boundingBox = lights[i]->getBoundingBox();
+		leaf.power = std::max(0.0f, lights[i]->getPower());
+
+		// Grow the bounding box by the range of the light, as its attenuation is measured from any point on the light
+		float range = lights[i]->getRange();
+		Vec3Df rangeExtent(range, range, range);
+
+		if (leaf.boundingBox.isEmpty() || !std::isfinite(range))
+			leaf.influenceBox = BoundingBox(-infinity, infinity);
+		else
+			leaf.influenceBox = BoundingBox(leaf.boundingBox.min - rangeExtent, leaf.boundingBox.max + rangeExtent);
+		leaf.parent = -1;
+		leaf.children[0] = -1;
+		leaf.children[1] = -1;
+		leaf.light = lights[i].get();
+
+		// Lights without a finite bounding box are placed at the origin
+		indices[i] = i;
+		centers[i] = leaf.boundingBox.isEmpty() || !std::isfinite(leaf.boundingBox.getSurfaceArea()) ? Vec3Df() : leaf.boundingBox.getCenter();
+
+		this->leaves[leaf.light] = i;
+
+		if (lights[i]->getGeometry())
+			this->geometryLights[lights[i]->getGeometry().get()] = leaf.light;
+	}
+
+	this->buildNode(indices, 0, (int)indices.size(), centers);
+}
+
+bool LightTree::isEmpty() const {
+	return this->nodes.empty();
+}
+
+const ILight *LightTree::chooseLight(const Vec3Df &point, float random, float &probability) const {
+	if (this->nodes.empty())
+		return nullptr;
+
+	// The root is the last node that was created
+	const Node *node = &this->nodes.back();
+	probability = 1.0f;
+
+	while (node->children[0] >= 0) {
+		float firstProbability = this->getFirstChildProbability(*node, point);
+
+		// Take a child and rescale the random number to [0, 1) for the next level
+		if (random < firstProbability) {
+			random = random / firstProbability;
+			probability *= firstProbability;
+			node = &this->nodes[node->children[0]];
+		}
+		else {
+			random = (random - firstProbability) / (1.0f - firstProbability);
+			probability *= 1.0f - firstProbability;
+			node = &this->nodes[node->children[1]];
+		}
+
+		random = std::min(random, 0.99999994f);
+	}
+
+	return node->light;
+}
+
+float LightTree::getProbability(const ILight *light, const Vec3Df &point) const {
+	std::unordered_map<const ILight *, int>::const_iterator it = this->leaves.find(light);
+
+	if (it == this->leaves.end())
+		return 0.0f;
+
+	float probability = 1.0f;
+	int index = it->second;
+
+	// Walk up to the root and multiply the probabilities of taking each node
+	while (this->nodes[index].parent >= 0) {
+		const Node &parent = this->nodes[this->nodes[index].parent];
+		float firstProbability = this->getFirstChildProbability(parent, point);
+
+		probability *= index == parent.children[0] ? firstProbability : 1.0f - firstProbability;
+		index = this->nodes[index].parent;
+	}
+
+	return probability;
+}
+
+const ILight *LightTree::findLight(const IGeometry *geometry) const {
+	std::unordered_map<const IGeometry *, const ILight *>::const_iterator it = this->geometryLights.find(geometry);
+
+	return it != this->geometryLights.end() ? it->second : nullptr;
+}
+
+int LightTree::buildNode(std::vector<int> &indices, int begin, int end, const std::vector<Vec3Df> &centers) {
+	if (end - begin == 1)
+		return indices[begin];
+
+	// Split the lights at the median of their centers along the largest axis of the centers
+	BoundingBox centerBounds;
+
+	for (int i = begin; i < end; i++)
+		centerBounds.includePoint(centers[indices[i]]);
+
+	Vec3Df extent = centerBounds.max - centerBounds.min;
+	int axis = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2) : (extent[1] > extent[2] ? 1 : 2);
+	int middle = (begin + end) / 2;
+
+	std::nth_element(
+		indices.begin() + begin,
+		indices.begin() + middle,
+		indices.begin() + end,
+		[&centers, axis](int a, int b) { return centers[a][axis] < centers[b][axis]; });
+
+	int first = this->buildNode(indices, begin, middle, centers);
+	int second = this->buildNode(indices, middle, end, centers);
+	int index = (int)this->nodes.size();
+
+	Node node;
+	node.boundingBox = this->nodes[first].boundingBox;
+	node.boundingBox.includeBoundingBox(this->nodes[second].boundingBox);
+	node.influenceBox = this->nodes[first].influenceBox;
+	node.influenceBox.includeBoundingBox(this->nodes[second].influenceBox);
+	node.power = this->nodes[first].power + this->nodes[second].power;
+	node.parent = -1;
+	node.children[0] = first;
+	node.children[1] = second;
+	node.light = nullptr;
+
+	this->nodes[first].parent = index;
+	this->nodes[second].parent = index;
+	this->nodes.push_back(node);
+
+	return index;
+}
+
+bool LightTree::reaches(const Node &node, const Vec3Df &point) const {
+	const BoundingBox &box = node.influenceBox;
+
+	if (point[0] < box.min[0] || point[0] > box.max[0] ||
+		point[1] < box.min[1] || point[1] > box.max[1] ||
+		point[2] < box.min[2] || point[2] > box.max[2])
+		return false;
+
+	// A light is only reached within its range of the closest point of its bounding box
+	if (node.children[0] < 0) {
+		float range = node.light->getRange();
+
+		if (std::isfinite(range)) {
+			float squaredDistance = 0.0f;
+
+			for (int i = 0; i < 3; i++) {
+				float d = std::max(std::max(node.boundingBox.min[i] - point[i], point[i] - node.boundingBox.max[i]), 0.0f);
+				squaredDistance += d * d;
+			}
+
+			return squaredDistance <= range * range;
+		}
+	}
+
+	return true;
+}
+
+float LightTree::calculateImportance(const Node &node, const Vec3Df &point) const {
+	// Lights that do not reach the point are never chosen
+	if (!this->reaches(node, point))
+		return 0.0f;
+
+	// Lights without a finite bounding box are as important everywhere
+	if (node.boundingBox.isEmpty() || !std::isfinite(node.boundingBox.getSurfaceArea()))
+		return node.power;
+
+	// Closer than the radius of the box the distance says little about the lights inside it
+	float squaredRadius = 0.25f * (node.boundingBox.max - node.boundingBox.min).getSquaredLength();
+	float squaredDistance = (node.boundingBox.getCenter() - point).getSquaredLength();
+
+	return node.power / std::max(std::max(squaredDistance, squaredRadius), 1e-6f);
+}
+
+float LightTree::getFirstChildProbability(const Node &node, const Vec3Df &point) const {
+	float first = this->calculateImportance(this->nodes[node.children[0]], point);
+	float second = this->calculateImportance(this->nodes[node.children[1]], point);
+
+	// If neither child is expected to contribute, take both alike
+	if (first + second <= 0.0f)
+		return 0.5f;
+
+	return first / (first + second);
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#ifndef LIGHTTREE_H
+#define LIGHTTREE_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "BoundingBox.h"
+#include "Vec3D.h"
+
+class IGeometry;
+class ILight;
+
+/**
+ * Implements a bounding volume hierarchy over lights, which chooses lights in proportion to their estimated contribution.
+ *
+ * Every node stores the bounding box and the total power of the lights below it. A light is chosen by descending from the root,
+ * taking each child with a probability proportional to its importance: its power divided by the squared distance to the point,
+ * which is clamped to the size of its bounding box. Choosing a light thus takes time logarithmic in the number of lights,
+ * and the probability of any light can be computed by walking back up from its leaf.
+ *
+ * Lights with falloff do not reach beyond their range. Every node also bounds the region the lights below it reach,
+ * so the lights reaching a point can be found without visiting the others, and lights are never chosen for points
+ * they do not reach.
+ */
+class LightTree {
+public:
+	LightTree();
+
+	/**
+	 * Builds the hierarchy over the given lights, the lights should be preprocessed.
+	 * @param[in] lights The lights.
+	 */
+	void build(const std::vector<std::shared_ptr<ILight>> &lights);
+
+	/**
+	 * Tests whether the hierarchy contains any light.
+	 * @return True if the hierarchy contains no lights; otherwise false.
+	 */
+	bool isEmpty() const;
+
+	/**
+	 * Chooses a light in proportion to its estimated contribution to the given point.
+	 * @param[in] point A point in the scene.
+	 * @param random A random number in the range [0, 1).
+	 * @param[out] probability The probability with which the light was chosen.
+	 * @return The chosen light, or nullptr if the hierarchy is empty.
+	 */
+	const ILight *chooseLight(const Vec3Df &point, float random, float &probability) const;
+
+	/**
+	 * Calculates the probability with which chooseLight chooses the given light for the given point.
+	 * @param[in] light The light.
+	 * @param[in] point A point in the scene.
+	 * @return The probability of the light, or zero if it is not in the hierarchy.
+	 */
+	float getProbability(const ILight *light, const Vec3Df &point) const;
+
+	/**
+	 * Finds the lights whose range reaches the given point.
+	 * Example usage: lightTree.findLights(point, visitor), where visitor(light) is called for every light reaching the point.
+	 * @param[in] point A point in the scene.
+	 * @param[in] visitor The function object that is called with every light reaching the point.
+	 */
+	template<class T>
+	void findLights(const Vec3Df &point, T &visitor) const {
+		if (this->nodes.empty())
+			return;
+
+		// The depth of the hierarchy is logarithmic in the number of lights, so the stack never grows large
+		int stack[64];
+		int stackSize = 0;
+
+		stack[stackSize++] = (int)this->nodes.size() - 1;
+
+		while (stackSize > 0) {
+			const Node &node = this->nodes[stack[--stackSize]];
+
+			if (!this->reaches(node, point))
+				continue;
+
+			if (node.children[0] < 0) {
+				visitor(node.light);
+			}
+			else {
+				stack[stackSize++] = node.children[1];
+				stack[stackSize++] = node.children[0];
+			}
+		}
+	}
+
+	/**
+	 * Finds the light whose geometry is the given geometry.
+	 * @param[in] geometry The geometry.
+	 * @return The light of the geometry, or nullptr if the geometry is not a light.
+	 */
+	const ILight *findLight(const IGeometry *geometry) const;
+
+private:
+	/**
+	 * A node of the hierarchy, which is either a leaf referring to a single light or has two children.
+	 * The leaves are stored first in the order of the lights, followed by the interior nodes. The root is the last node.
+	 */
+	struct Node {
+		/**
+		 * A box bounding all lights below this node.
+		 */
+		BoundingBox boundingBox;
+
+		/**
+		 * A box bounding the region reached by the lights below this node, which is infinite for lights without falloff.
+		 */
+		BoundingBox influenceBox;
+
+		/**
+		 * The total power of all lights below this node.
+		 */
+		float power;
+
+		/**
+		 * The index of the parent node, or -1 for the root.
+		 */
+		int parent;
+
+		/**
+		 * The indices of the two children, -1 for leaves.
+		 */
+		int children[2];
+
+		/**
+		 * The light of a leaf.
+		 */
+		const ILight *light;
+	};
+
+	/**
+	 * Recursively builds the hierarchy for the lights in the range [begin, end) of the given indices.
+	 * @return The index of the node.
+	 */
+	int buildNode(std::vector<int> &indices, int begin, int end, const std::vector<Vec3Df> &centers);
+
+	/**
+	 * Tests whether the lights below the given node may reach the given point.
+	 */
+	bool reaches(const Node &node, const Vec3Df &point) const;
+
+	/**
+	 * Calculates the importance of a node for the given point.
+	 */
+	float calculateImportance(const Node &node, const Vec3Df &point) const;
+
+	/**
+	 * Calculates the probability of choosing the first child of the given node for the given point.
+	 */
+	float getFirstChildProbability(const Node &node, const Vec3Df &point) const;
+
+	std::vector<Node> nodes;
+	std::unordered_map<const ILight *, int> leaves;
+	std::unordered_map<const IGeometry *, const ILight *> geometryLights;
+};
+
+#endif
@@ -2,30 +2,36 @@
 #include <cassert>
 #include <math.h>
 
+#include "BVHAccelerator.h"
 #include "IAccelerationStructure.h"
 #include "mesh.h"
 #include "MeshGeometry.h"
-#include "MeshTriangleGeometry.h"
-#include "NoAccelerationStructure.h"
-#include "Octree.h"
 #include "Random.h"
+#include "Ray.h"
+#include "RayIntersection.h"
 #include "SurfacePoint.h"
+#include "Transform.h"
+#include "TrianglePrimitiveSet.h"
 
 MeshGeometry::MeshGeometry(const Mesh *mesh) : 
 accelerator(nullptr),
 boundingBox(BoundingBox()),
-maxTriangleArea(0),
 mesh(mesh),
+preprocessed(false),
 totalArea(0),
-triangles(MeshGeometry::generateTriangles(mesh)){
+triangles(std::make_shared<TrianglePrimitiveSet>(mesh)){
 	assert(mesh);
 
-	this->setAccelerationStructure(std::make_shared<Octree>());
+	this->setAccelerationStructure(std::make_shared<BVHAccelerator>());
 }
 
 MeshGeometry::~MeshGeometry() {
 }
 
+const Mesh *MeshGeometry::getMesh() const {
+	return this->mesh;
+}
+
 std::shared_ptr<IAccelerationStructure> MeshGeometry::getAccelerationStructure() const {
 	// Return the pointer to the acceleration structure
 	return this->accelerator;
@@ -34,89 +40,147 @@ std::shared_ptr<IAccelerationStructure> MeshGeometry::getAccelerationStructure()
 void MeshGeometry::setAccelerationStructure(std::shared_ptr<IAccelerationStructure> accelerator) {
 	assert(accelerator);
 
-	// Set the acceleration structure and set its geometry vector to the scene's geometry
+	// Set the acceleration structure and set its primitives to the triangles of the mesh
 	this->accelerator = accelerator;
-	this->accelerator->setGeometry(this->triangles);
+	this->accelerator->setPrimitives(this->triangles);
+
+	// The new acceleration structure still needs to be built
+	this->preprocessed = false;
 }
 
 void MeshGeometry::preprocess() {
-	float totalArea = 0.0f;
-	float maxTriangleArea = 0.0f;
-	std::shared_ptr<const IMaterial> material = this->getMaterial();
-
-	// Preprocess all triangles and calculate the total surface area and
-	// the surface area of the biggest triangle
-	for (std::vector<std::shared_ptr<IGeometry>>::const_iterator it = this->triangles->begin(); it != this->triangles->end(); ++it) {
-		(*it)->preprocess();
-		(*it)->setMaterial(material);
-
-		float area = (*it)->getArea();
-		totalArea += area;
-		maxTriangleArea = std::max<float>(area, maxTriangleArea);
+	// Instances share this mesh, so only preprocess it once
+	if (this->preprocessed)
+		return;
+
+	double totalArea = 0.0;
+	std::vector<float> areas(this->mesh->triangles.size());
+
+	// Calculate the total surface area and the surface area of every triangle
+	for (unsigned int i = 0; i < this->mesh->triangles.size(); i++) {
+		areas[i] = this->getTriangleArea(i);
+		totalArea += areas[i];
 	}
 
-	// Set the total surface area and maximum surface area of a triangle
-	this->totalArea = totalArea;
-	this->maxTriangleArea = maxTriangleArea;
+	// Set the total surface area and build the table choosing triangles in proportion to their area
+	this->totalArea = (float)totalArea;
+	this->triangleAreas.build(areas);
 
 	// Compute the bounding box
 	this->boundingBox = MeshGeometry::createBoundingBox(this->mesh);
 
 	// Preprocess the acceleration structure
 	this->accelerator->preprocess();
+
+	this->preprocessed = true;
 }
 
 float MeshGeometry::getArea() const {
 	return this->totalArea;
 }
 
-bool MeshGeometry::calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const {
+float MeshGeometry::getTransformedArea(const Transform &transform) {
+	assert(this->preprocessed);
+
+	if (transform.isSimilarity())
+		return this->totalArea * powf(fabsf(transform.getDeterminant()), 2.0f / 3.0f);
+
+	return this->getTransformedAreas(transform).totalArea;
+}
+
+const AliasTable *MeshGeometry::getTransformedTriangleAreas(const Transform &transform) {
+	assert(this->preprocessed);
+
+	// A similarity scales every triangle alike, so the proportions between them stay the same
+	if (transform.isSimilarity())
+		return nullptr;
+
+	return &this->getTransformedAreas(transform).triangleAreas;
+}
+
+bool MeshGeometry::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
 	// If the ray does not intersect the bounding box, return null
-	if (!this->boundingBox.intersects(origin, dir))
+	if (!this->boundingBox.intersects(ray))
 		return false;
 
 	// Let the acceleration structure handle the intersection in our set of triangles
-	return this->accelerator->calculateClosestIntersection(origin, dir, intersection);
-}
+	if (!this->accelerator->calculateClosestIntersection(ray, intersection))
+		return false;
 
-bool MeshGeometry::calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const {
-	float distance;
+	// The triangles are not geometry themselves, the hit is identified by the primitive index
+	intersection.geometry = this;
 
-	// If the ray does not intersect the bounding box within the given maximum distance, return null
-	if (!this->boundingBox.intersects(origin, dir, distance) || distance > maxDistance)
+	return true;
+}
+
+bool MeshGeometry::calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const {
+	// If the ray does not intersect the bounding box within the interval of the ray, return null
+	if (!this->boundingBox.intersects(ray))
 		return false;
 
 	// Let the acceleration structure handle the intersection in our set of triangles
-	return this->accelerator->calculateAnyIntersection(origin, dir, maxDistance, intersection);
+	if (!this->accelerator->calculateAnyIntersection(ray, intersection))
+		return false;
+
+	intersection.geometry = this;
+
+	return true;
 }
 
 void MeshGeometry::getSurfacePoint(const RayIntersection &intersection, SurfacePoint &surface) const {
-	// We are intersecting against the triangles within the mesh, so the geometry pointer of RayIntersection
-	// will not point to the mesh geometry but instead to the triangle. There is no real need to implement this.
-	assert(false);
+	surface.geometry = intersection.geometry;
+	surface.point = intersection.hitPoint;
+	surface.isInside = intersection.isInside;
+
+	// Get the normal by interpolating the vertex normals
+	surface.normal = this->getSurfaceNormal(intersection.primitiveIndex, intersection.barycentricCoordinates);
+
+	// Flip the normal if the intersection occured on the inside of the primitive
+	if (intersection.isInside) {
+		surface.normal = -surface.normal;
+	}
+
+	// Find the texture coordinates
+	surface.texCoords = this->getTextureCoordinates(intersection.primitiveIndex, intersection.barycentricCoordinates);
 }
 
 void MeshGeometry::getRandomSurfacePoint(SurfacePoint &surface) const {
-	// Get the number of triangles
-	int numTriangles = this->mesh->triangles.size();
+	float u, v;
 
-	// Get the maxium surface area of a triangle and
-	// gerate a random surface area in the range [0, maxArea]
-	float maxArea = this->maxTriangleArea;
-	float randomArea = Random::randUnit() * totalArea;
+	// Get two numbers in the range [0, 1]
+	Random::sampleUnitSquare(u, v);
 
-	std::shared_ptr<IGeometry> triangle;
+	this->sampleSurfacePoint(u, v, surface);
+}
 
-	// Use rejection sampling on the triangle's area
-	// to pick a uniformly distributed random triangle
-	do{
-		// Get a random triangle
-		int index = Random::rand() % numTriangles;
-		triangle = this->triangles->at(index);
-	} while (triangle->getArea() < randomArea);
+void MeshGeometry::sampleSurfacePoint(float u, float v, SurfacePoint &surface) const {
+	this->sampleSurfacePoint(this->triangleAreas, u, v, surface);
+}
 
-	// Return a uniformly distributed random within the triangle
-	return triangle->getRandomSurfacePoint(surface);
+void MeshGeometry::sampleSurfacePoint(const AliasTable &triangleAreas, float u, float v, SurfacePoint &surface) const {
+	assert(this->preprocessed);
+	assert(!triangleAreas.isEmpty());
+
+	// Pick a triangle in proportion to its area, what is left of the numbers is still uniformly distributed
+	unsigned int index = triangleAreas.chooseIndex(u, v);
+
+	// Calculate the square root of the first number
+	float sqrtU = sqrtf(u);
+
+	// Interpolate the vertices of the triangle in such a 
+	// way that this provides uniform sampling.
+	// Source: http://www.cs.princeton.edu/~funk/tog02.pdf section 4.2
+	const Triangle &triangle = this->mesh->triangles[index];
+	Vec2Df barycentricCoordinates(sqrtU * (1.0f - v), sqrtU * v);
+
+	surface.geometry = this;
+	surface.point =
+		(1.0f - sqrtU) * this->mesh->vertices[triangle.v[0]].p +
+		barycentricCoordinates[0] * this->mesh->vertices[triangle.v[1]].p +
+		barycentricCoordinates[1] * this->mesh->vertices[triangle.v[2]].p;
+	surface.normal = this->getSurfaceNormal(index, barycentricCoordinates);
+	surface.texCoords = this->getTextureCoordinates(index, barycentricCoordinates);
+	surface.isInside = false;
 }
 
 BoundingBox MeshGeometry::getBoundingBox() const {
@@ -135,13 +199,91 @@ BoundingBox MeshGeometry::createBoundingBox(const Mesh *mesh) {
 	return result;
 }
 
-std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> MeshGeometry::generateTriangles(const Mesh *mesh) {
-	auto triangles = std::make_shared<std::vector<std::shared_ptr<IGeometry>>>();
+Vec3Df MeshGeometry::getSurfaceNormal(unsigned int index, const Vec2Df &barycentricCoordinates) const {
+	const Triangle &triangle = this->mesh->triangles[index];
+
+	// Get the vertex normals
+	Vec3Df normal0 = this->mesh->vertices[triangle.v[0]].n;
+	Vec3Df normal1 = this->mesh->vertices[triangle.v[1]].n;
+	Vec3Df normal2 = this->mesh->vertices[triangle.v[2]].n;
+
+	// Interpolate between the vertices
+	Vec3Df normal = (1.0f - barycentricCoordinates[0] - barycentricCoordinates[1]) * normal0 +
+		barycentricCoordinates[0] * normal1 + barycentricCoordinates[1] * normal2;
+
+	normal.normalize();
+
+	return normal;
+}
+
+Vec2Df MeshGeometry::getTextureCoordinates(unsigned int index, const Vec2Df &barycentricCoordinates) const {
+	float weight0 = 1.0f - barycentricCoordinates[0] - barycentricCoordinates[1];
+
+	// Check if the mesh has texture coordinates
+	if (this->mesh->texcoords.size() > 0) {
+		const Triangle &triangle = this->mesh->triangles[index];
+
+		// Get the vertex texture coordinates
+		Vec3Df uv0 = this->mesh->texcoords[triangle.v[0]];
+		Vec3Df uv1 = this->mesh->texcoords[triangle.v[1]];
+		Vec3Df uv2 = this->mesh->texcoords[triangle.v[2]];
+
+		// Interpolate between the vertices
+		Vec3Df uv3 = weight0 * uv0 + barycentricCoordinates[0] * uv1 + barycentricCoordinates[1] * uv2;
+
+		return Vec2Df(uv3[0], uv3[1]);
+	}
+	// Otherwise return the barycentric coordinates of the first two vertices
+	else {
+		return Vec2Df(weight0, barycentricCoordinates[0]);
+	}
+}
+
+float MeshGeometry::getTriangleArea(unsigned int index) const {
+	const Triangle &triangle = this->mesh->triangles[index];
+
+	Vec3Df vertex0 = this->mesh->vertices[triangle.v[0]].p;
+	Vec3Df edge1 = this->mesh->vertices[triangle.v[1]].p - vertex0;
+	Vec3Df edge2 = this->mesh->vertices[triangle.v[2]].p - vertex0;
+
+	// Same as BaseTriangleGeometry, half the length of the cross product of the edges
+	return 0.5f * Vec3Df::crossProduct(edge1, edge2).getLength();
+}
+
+const MeshGeometry::TransformedAreas &MeshGeometry::getTransformedAreas(const Transform &transform) {
+	// The areas only depend on the linear part, which is given by the images of the axes
+	Vec3Df axes[3] = {
+		transform.transformVector(Vec3Df(1.0f, 0.0f, 0.0f)),
+		transform.transformVector(Vec3Df(0.0f, 1.0f, 0.0f)),
+		transform.transformVector(Vec3Df(0.0f, 0.0f, 1.0f))
+	};
+	std::vector<float> key(9);
+
+	for (int i = 0; i < 9; i++)
+		key[i] = axes[i / 3][i % 3];
 
-	// Create a MeshTriangleGeometry for each triangle
-	for (std::vector<Triangle>::const_iterator it = mesh->triangles.begin(); it != mesh->triangles.end(); ++it) {
-		triangles->push_back(std::make_shared<MeshTriangleGeometry>(mesh, &(*it)));
+	std::map<std::vector<float>, TransformedAreas>::const_iterator it = this->transformedAreas.find(key);
+
+	if (it != this->transformedAreas.end())
+		return it->second;
+
+	double totalArea = 0.0;
+	std::vector<float> areas(this->mesh->triangles.size());
+
+	for (unsigned int i = 0; i < this->mesh->triangles.size(); i++) {
+		const Triangle &triangle = this->mesh->triangles[i];
+
+		Vec3Df vertex0 = this->mesh->vertices[triangle.v[0]].p;
+		Vec3Df edge1 = transform.transformVector(this->mesh->vertices[triangle.v[1]].p - vertex0);
+		Vec3Df edge2 = transform.transformVector(this->mesh->vertices[triangle.v[2]].p - vertex0);
+
+		areas[i] = 0.5f * Vec3Df::crossProduct(edge1, edge2).getLength();
+		totalArea += areas[i];
 	}
 
-	return triangles;
+	TransformedAreas &transformedAreas = this->transformedAreas[key];
+	transformedAreas.totalArea = (float)totalArea;
+	transformedAreas.triangleAreas.build(areas);
+
+	return transformedAreas;
 }
\ No newline at end of file
@@ -1,16 +1,24 @@
 #ifndef MESHGEOMETRY_H
 #define MESHGEOMETRY_H
 
+#include <map>
 #include <vector>
 
+#include "AliasTable.h"
 #include "IGeometry.h"
+#include "Vec2D.h"
 #include "Vec3D.h"
 
 class IAccelerationStructure;
 class Mesh;
+class Transform;
+class TrianglePrimitiveSet;
 
 /**
  * Represents a triangle mesh.
+ *
+ * The triangles are stored as a TrianglePrimitiveSet, which the acceleration structure refers to by index.
+ * A hit is identified by the index of the triangle and the barycentric coordinates within it.
  */
 class MeshGeometry : public IGeometry {
 public:
@@ -20,6 +28,12 @@ public:
 	MeshGeometry(const Mesh *mesh);
 	~MeshGeometry();
 
+	/**
+	 * Gets the mesh.
+	 * @return Pointer to the mesh.
+	 */
+	const Mesh *getMesh() const;
+
 	/**
 	 * Gets the acceleration structure that is used to find speed up
 	 * the intersection calculations.
@@ -36,6 +50,7 @@ public:
 
 	/**
 	 * Perform any necessary preprocessing.
+	 * The mesh is only preprocessed once, so it can be shared by any number of instances.
 	 */
 	void preprocess();
 
@@ -45,26 +60,42 @@ public:
 	*/
 	float getArea() const;
 
+	/**
+	 * Gets the surface area of the mesh after transforming it with the given transformation, the mesh should be preprocessed.
+	 * A similarity scales the area of the mesh by the determinant to the power of two thirds. Other transformations
+	 * scale every triangle differently, so their area is summed over the triangles once per linear part and remembered
+	 * for the other instances placed with the same linear part.
+	 * @param[in] transform The transformation.
+	 * @return The surface area of the transformed mesh.
+	 */
+	float getTransformedArea(const Transform &transform);
+
+	/**
+	 * Gets the table choosing the triangles of the mesh in proportion to their area after transforming them with the given
+	 * transformation, the mesh should be preprocessed. The table is built along with the area for transformations which
+	 * are not similarities, since those change the proportions between the triangles.
+	 * @param[in] transform The transformation.
+	 * @return The table of the transformed triangles, or nullptr if the transformation is a similarity and the table of the mesh applies.
+	 */
+	const AliasTable *getTransformedTriangleAreas(const Transform &transform);
+
 	/*
 	 * Calculates whether the mesh is hit by the given ray and sets the intersection parameter
 	 * to the RayIntersection representing the closest point of intersection.
-	 * @param[in] origin The origin of the ray.
-	 * @param[in] dir The direction of the ray.
+	 * @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
 	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	 * @return True if the ray intersected an object; otherwise false.
 	 */
-	bool calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const;
+	bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const;
 
 	/*
 	 * Returns whether the mesh is hit by the given ray and sets the intersection parameter
 	 * to the RayIntersection representing the point of intersection.
-	 * @param[in] origin The origin of the ray.
-	 * @param[in] dir The direction of the ray.
-	 * @param maxDistance The maximum distance at which the intersection may occur.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
 	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	 * @return True if the ray intersected an object; otherwise false.
 	 */
-	bool calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const;
+	bool calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const;
 
 	/**
 	 * Gets the surface point on this mesh at the given intersection point.
@@ -79,19 +110,74 @@ public:
 	 */
 	void getRandomSurfacePoint(SurfacePoint &surface) const;
 
+	/**
+	 * Maps a point in the unit square to a surface point on this mesh, uniformly by area.
+	 * The triangle is chosen in proportion to its area in constant time, after which the rest
+	 * of the numbers choose the point within the triangle.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] surface The surface point.
+	 */
+	void sampleSurfacePoint(float u, float v, SurfacePoint &surface) const;
+
+	/**
+	 * Maps a point in the unit square to a surface point on this mesh, choosing the triangle with the given table.
+	 * This samples the mesh uniformly by area after a transformation that scales its triangles differently.
+	 * @param[in] triangleAreas The table choosing the triangles, which has an entry for every triangle.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] surface The surface point.
+	 */
+	void sampleSurfacePoint(const AliasTable &triangleAreas, float u, float v, SurfacePoint &surface) const;
+
 	BoundingBox getBoundingBox() const;
 
 private:
-	static std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> generateTriangles(const Mesh *mesh);
+	/**
+	 * Gets the normal of the triangle with the given index by interpolating its vertex normals.
+	 * @param index The index of the triangle.
+	 * @param[in] barycentricCoordinates The weights of the second and third vertex.
+	 * @return The interpolated normal.
+	 */
+	Vec3Df getSurfaceNormal(unsigned int index, const Vec2Df &barycentricCoordinates) const;
+
+	/**
+	 * Gets the texture coordinates within the triangle with the given index by interpolating its vertex texture coordinates.
+	 * @param index The index of the triangle.
+	 * @param[in] barycentricCoordinates The weights of the second and third vertex.
+	 * @return The interpolated texture coordinates.
+	 */
+	Vec2Df getTextureCoordinates(unsigned int index, const Vec2Df &barycentricCoordinates) const;
+
+	/**
+	 * The surface area of the mesh and the table choosing its triangles after a transformation.
+	 */
+	struct TransformedAreas {
+		float totalArea;
+		AliasTable triangleAreas;
+	};
+
+	/**
+	 * Gets the surface area of the triangle with the given index.
+	 */
+	float getTriangleArea(unsigned int index) const;
+
+	/**
+	 * Gets the areas of the mesh after transforming it with the given transformation, which is not a similarity.
+	 * They are calculated once per linear part of the transformation and remembered for other instances.
+	 */
+	const TransformedAreas &getTransformedAreas(const Transform &transform);
 
 	static BoundingBox createBoundingBox(const Mesh *mesh);
 
 	const Mesh *mesh;
+	bool preprocessed;
 	float totalArea;
-	float maxTriangleArea;
+	AliasTable triangleAreas;
+	std::map<std::vector<float>, TransformedAreas> transformedAreas;
 	BoundingBox boundingBox;
 	std::shared_ptr<IAccelerationStructure> accelerator;
-	std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> triangles;
+	std::shared_ptr<const TrianglePrimitiveSet> triangles;
 };
 
 #endif
\ No newline at end of file
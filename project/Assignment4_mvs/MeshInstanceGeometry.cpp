@@ -0,0 +1,137 @@
+#include <cassert>
+#include <math.h>
+
+#include "MeshGeometry.h"
+#include "MeshInstanceGeometry.h"
+#include "Random.h"
+#include "Ray.h"
+#include "RayIntersection.h"
+#include "SurfacePoint.h"
+
+MeshInstanceGeometry::MeshInstanceGeometry(std::shared_ptr<MeshGeometry> mesh, const Transform &transform)
+: IGeometry(mesh->getMaterial()),
+area(0.0f),
+boundingBox(BoundingBox()),
+transform(transform),
+inverseTransform(transform.getInverse()),
+mesh(mesh),
+triangleAreas(nullptr) {
+	assert(mesh);
+}
+
+std::shared_ptr<const MeshGeometry> MeshInstanceGeometry::getMesh() const {
+	return this->mesh;
+}
+
+const Transform &MeshInstanceGeometry::getTransform() const {
+	return this->transform;
+}
+
+void MeshInstanceGeometry::preprocess() {
+	// Preprocess the mesh, this does nothing if it was already preprocessed for another instance
+	this->mesh->preprocess();
+
+	// Transform the bounding box of the mesh to world space
+	this->boundingBox = this->transform.transformBoundingBox(this->mesh->getBoundingBox());
+
+	// The mesh computes the area in world space, this only walks its triangles for transforms which scale non-uniformly
+	this->area = this->mesh->getTransformedArea(this->transform);
+
+	// Transforms which scale the triangles differently also change how often each triangle should be sampled
+	this->triangleAreas = this->mesh->getTransformedTriangleAreas(this->transform);
+}
+
+float MeshInstanceGeometry::getArea() const {
+	return this->area;
+}
+
+bool MeshInstanceGeometry::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
+	RayIntersection localIntersection;
+	Ray localRay = this->getLocalRay(ray);
+
+	if (!this->mesh->calculateClosestIntersection(localRay, localIntersection))
+		return false;
+
+	this->setIntersection(ray, localIntersection, intersection);
+
+	// Distances are the same in both spaces
+	ray.maxDistance = localRay.maxDistance;
+
+	return true;
+}
+
+bool MeshInstanceGeometry::calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const {
+	RayIntersection localIntersection;
+
+	if (!this->mesh->calculateAnyIntersection(this->getLocalRay(ray), localIntersection))
+		return false;
+
+	this->setIntersection(ray, localIntersection, intersection);
+
+	return true;
+}
+
+void MeshInstanceGeometry::getSurfacePoint(const RayIntersection &intersection, SurfacePoint &surface) const {
+	RayIntersection localIntersection = intersection;
+
+	// Reconstruct the intersection with the mesh in object space, the primitive index
+	// and barycentric coordinates of the hit triangle are the same in both spaces
+	localIntersection.geometry = this->mesh.get();
+	localIntersection.origin = this->inverseTransform.transformPoint(intersection.origin);
+	localIntersection.direction = this->inverseTransform.transformVector(intersection.direction);
+	localIntersection.hitPoint = localIntersection.origin + intersection.distance * localIntersection.direction;
+
+	localIntersection.getSurfacePoint(surface);
+
+	// Transform the surface point back to world space
+	surface.geometry = intersection.geometry;
+	surface.point = intersection.hitPoint;
+	surface.normal = this->transform.transformNormal(surface.normal);
+	surface.normal.normalize();
+}
+
+void MeshInstanceGeometry::getRandomSurfacePoint(SurfacePoint &surface) const {
+	float u, v;
+	Random::sampleUnitSquare(u, v);
+
+	this->sampleSurfacePoint(u, v, surface);
+}
+
+void MeshInstanceGeometry::sampleSurfacePoint(float u, float v, SurfacePoint &surface) const {
+	// Choose the triangles by their area in world space if it is not proportional to their area in object space
+	if (this->triangleAreas)
+		this->mesh->sampleSurfacePoint(*this->triangleAreas, u, v, surface);
+	else
+		this->mesh->sampleSurfacePoint(u, v, surface);
+
+	// Transform the surface point to world space
+	surface.geometry = this;
+	surface.point = this->transform.transformPoint(surface.point);
+	surface.normal = this->transform.transformNormal(surface.normal);
+	surface.normal.normalize();
+}
+
+BoundingBox MeshInstanceGeometry::getBoundingBox() const {
+	return this->boundingBox;
+}
+
+Ray MeshInstanceGeometry::getLocalRay(const Ray &ray) const {
+	// Transform the ray to object space. The direction is not normalized,
+	// so distances along the ray and thus its interval are the same in both spaces.
+	Vec3Df localOrigin = this->inverseTransform.transformPoint(ray.origin);
+	Vec3Df localDir = this->inverseTransform.transformVector(ray.direction);
+
+	return Ray(localOrigin, localDir, ray.minDistance, ray.maxDistance);
+}
+
+void MeshInstanceGeometry::setIntersection(const Ray &ray, const RayIntersection &localIntersection, RayIntersection &intersection) const {
+	// Remember the triangle that was hit, the surface point is computed from it in object space
+	intersection.geometry = this;
+	intersection.primitiveIndex = localIntersection.primitiveIndex;
+	intersection.barycentricCoordinates = localIntersection.barycentricCoordinates;
+	intersection.origin = ray.origin;
+	intersection.direction = ray.direction;
+	intersection.distance = localIntersection.distance;
+	intersection.hitPoint = ray.getPoint(localIntersection.distance);
+	intersection.isInside = localIntersection.isInside;
+}
\ No newline at end of file
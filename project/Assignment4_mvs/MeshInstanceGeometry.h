@@ -0,0 +1,113 @@
+#ifndef MESHINSTANCEGEOMETRY_H
+#define MESHINSTANCEGEOMETRY_H
+
+#include "IGeometry.h"
+#include "Transform.h"
+#include "Vec3D.h"
+
+class AliasTable;
+class MeshGeometry;
+
+/**
+ * Represents a placement of a shared mesh in the scene.
+ *
+ * Rays are transformed into the object space of the mesh, so any number of instances
+ * share a single copy of the mesh and its acceleration structure.
+ */
+class MeshInstanceGeometry : public IGeometry {
+public:
+	/**
+	 * Initializes a MeshInstanceGeometry which places the given mesh using the given transform.
+	 * The instance initially uses the material of the mesh.
+	 * @param[in] mesh Pointer to the mesh that is instanced.
+	 * @param[in] transform The transformation from the object space of the mesh to world space.
+	 */
+	MeshInstanceGeometry(std::shared_ptr<MeshGeometry> mesh, const Transform &transform);
+
+	/**
+	 * Gets the mesh that is instanced.
+	 * @return Pointer to the mesh that is instanced.
+	 */
+	std::shared_ptr<const MeshGeometry> getMesh() const;
+
+	/**
+	 * Gets the transformation from the object space of the mesh to world space.
+	 * @return The transformation from the object space of the mesh to world space.
+	 */
+	const Transform &getTransform() const;
+
+	/**
+	 * Perform any necessary preprocessing.
+	 */
+	void preprocess();
+
+	/**
+	 * Gets the surface area of the geometry.
+	 * @return The surface area of the geometry.
+	 */
+	float getArea() const;
+
+	/*
+	 * Calculates whether the instance is hit by the given ray and sets the intersection parameter
+	 * to the RayIntersection representing the closest point of intersection.
+	 * @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
+	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	 * @return True if the ray intersected an object; otherwise false.
+	 */
+	bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const;
+
+	/*
+	 * Returns whether the instance is hit by the given ray and sets the intersection parameter
+	 * to the RayIntersection representing the point of intersection.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
+	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	 * @return True if the ray intersected an object; otherwise false.
+	 */
+	bool calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const;
+
+	/**
+	 * Gets the surface point on this instance at the given intersection point.
+	 * @param[in] intersection An intersection point between a ray and this object.
+	 * @return The surface point on this instance at the given intersection point.
+	 */
+	void getSurfacePoint(const RayIntersection &intersection, SurfacePoint &surface) const;
+
+	/**
+	 * Gets a random surface point on this instance.
+	 * @return A random surface point on this instance.
+	 * @remarks Points are uniformly distributed over the mesh in object space,
+	 * so the distribution is only uniform for transforms which scale uniformly.
+	 */
+	void getRandomSurfacePoint(SurfacePoint &surface) const;
+
+	/**
+	 * Maps a point in the unit square to a surface point on this instance by mapping it on the mesh in object space,
+	 * choosing the triangles in proportion to their area in world space so the points are uniformly distributed by area.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] surface The surface point.
+	 */
+	void sampleSurfacePoint(float u, float v, SurfacePoint &surface) const;
+
+	BoundingBox getBoundingBox() const;
+
+private:
+	/**
+	 * Transforms the given ray to the object space of the mesh.
+	 */
+	Ray getLocalRay(const Ray &ray) const;
+
+	/**
+	 * Converts an intersection with the mesh in object space to an intersection with this instance.
+	 */
+	void setIntersection(const Ray &ray, const RayIntersection &localIntersection, RayIntersection &intersection) const;
+
+	float area;
+	BoundingBox boundingBox;
+	Transform transform;
+	Transform inverseTransform;
+	std::shared_ptr<MeshGeometry> mesh;
+	const AliasTable *triangleAreas;
+};
+
+#endif
\ No newline at end of file
@@ -1,52 +1,31 @@
-#include "IGeometry.h"
-#include <limits>
-
+#include "IPrimitiveSet.h"
 #include "NoAccelerationStructure.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 
-bool NoAccelerationStructure::calculateClosestIntersection(const Vec3Df & origin, const Vec3Df & dir, RayIntersection &intersection) const {
-	std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry = this->getGeometry();
-
-	RayIntersection lastIntersection;	
-	intersection = RayIntersection();
-	intersection.distance = std::numeric_limits<float>::infinity();
+bool NoAccelerationStructure::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
+	// Use a plain pointer, copying the shared_ptr would update its reference count for every ray
+	const IPrimitiveSet *primitives = this->getPrimitives().get();
 
 	bool intersectsAny = false;
 
-	// Iterate through all geometry in the scene
-	for (std::vector<std::shared_ptr<IGeometry>>::const_iterator it = geometry->begin(); it != geometry->end(); ++it) {
-		// Find the intersection between the ray and the geometry
-		bool intersects = (*it)->calculateClosestIntersection(origin, dir, lastIntersection);
-
-		// If no intersection was found, continue
-		if (!intersects) {
-			continue;
-		}
-
-		// If this is the first intersection, set it intersection the the last intersection
-		if (!intersectsAny) {
-			intersection = lastIntersection;
+	// Iterate through all primitives, the intersection is only updated if the primitive is hit closer
+	for (unsigned int i = 0; i < primitives->getPrimitiveCount(); i++) {
+		if (primitives->calculateClosestIntersection(&i, 1, ray, intersection)) {
 			intersectsAny = true;
 		}
-		// Otherwise, set intersection to last intersection only if it is closer than the current best intersection
-		else if (lastIntersection.distance < intersection.distance) {
-			intersection = lastIntersection;
-		}
 	}
 
 	return intersectsAny;
 }
 
-bool NoAccelerationStructure::calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const {
-	std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry = this->getGeometry();
-
-	// Iterate through all geometry in the scene
-	for (std::vector<std::shared_ptr<IGeometry>>::const_iterator it = geometry->begin(); it != geometry->end(); ++it) {
-		// Find the intersection between the ray and the geometry
-		bool intersects = (*it)->calculateAnyIntersection(origin, dir, maxDistance, intersection);
+bool NoAccelerationStructure::calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const {
+	const IPrimitiveSet *primitives = this->getPrimitives().get();
 
+	// Iterate through all primitives
+	for (unsigned int i = 0; i < primitives->getPrimitiveCount(); i++) {
 		// If an intersection was found, return it
-		if (intersects) {
+		if (primitives->calculateAnyIntersection(&i, 1, ray, intersection)) {
 			return true;
 		}
 	}
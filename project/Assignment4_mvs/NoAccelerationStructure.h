@@ -3,6 +3,7 @@
 
 #include "IAccelerationStructure.h"
 
+class Ray;
 class RayIntersection;
 
 /**
@@ -14,23 +15,20 @@ public:
 	/*
 	 * Returns whether any object is hit by the given ray and sets the intersection parameter
 	 * to the RayIntersection representing the closest point of intersection.
-	 * @param[in] origin The origin of the ray.
-	 * @param[in] dir The direction of the ray.
+	 * @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
 	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	 * @return True if the ray intersected an object; otherwise false.
 	 */
-	bool calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const;
+	bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const;
 
 	/*
 	 * Returns whether any object is hit by the given ray and sets the intersection parameter
 	 * to the RayIntersection representing the point of intersection.
-	 * @param[in] origin The origin of the ray.
-	 * @param[in] dir The direction of the ray.
-	 * @param maxDistance The maximum distance at which the intersection may occur.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
 	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	 * @return True if the ray intersected an object; otherwise false.
 	 */
-	bool calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const;
+	bool calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const;
 };
 
 #endif
\ No newline at end of file
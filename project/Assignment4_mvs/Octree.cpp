@@ -1,26 +1,46 @@
-#include <limits>
-
 #include "Octree.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 
-Octree::Octree() {
+Octree::Octree()
+: loose(false), root(nullptr) {
+}
+
+Octree::~Octree() {
+	delete this->root;
+}
+
+bool Octree::isLoose() const {
+	return this->loose;
+}
+
+void Octree::setLoose(bool loose) {
+	this->loose = loose;
 }
 
 void Octree::preprocess() {
-	std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>> geometry = this->getGeometry();
+	const IPrimitiveSet *primitives = this->getPrimitives().get();
 
-	std::vector<std::shared_ptr<IGeometry>> *tempGeometry = new std::vector<std::shared_ptr<IGeometry>>(geometry->begin(), geometry->end());
+	// The root initially contains every primitive
+	std::vector<unsigned int> *indices = new std::vector<unsigned int>(primitives->getPrimitiveCount());
 
-	this->root = new OctreeNode(tempGeometry);
+	for (unsigned int i = 0; i < indices->size(); i++) {
+		(*indices)[i] = i;
+	}
+
+	delete this->root;
+	this->root = new OctreeNode(primitives, indices, this->loose);
 }
 
-bool Octree::calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const {
-	intersection = RayIntersection();
-	intersection.distance = std::numeric_limits<float>::infinity();
+bool Octree::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
+	// Primitives are only referenced by multiple leaves if the octree is not loose
+	OctreeMailbox mailbox;
 
-	return this->root->calculateClosestIntersection(origin, dir, intersection);
+	return this->root->calculateClosestIntersection(ray, intersection, this->loose ? nullptr : &mailbox);
 }
 
-bool Octree::calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const {
-	return this->root->calculateAnyIntersection(origin, dir, maxDistance, intersection);
+bool Octree::calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const {
+	OctreeMailbox mailbox;
+
+	return this->root->calculateAnyIntersection(ray, intersection, this->loose ? nullptr : &mailbox);
 }
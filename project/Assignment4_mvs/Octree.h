@@ -4,11 +4,27 @@
 #include "IAccelerationStructure.h"
 #include "OctreeNode.h"
 
+class Ray;
 class RayIntersection;
 
 class Octree : public IAccelerationStructure {
 public:
 	Octree();
+	~Octree();
+
+	/**
+	* Gets whether the octree is loose.
+	* @return True if primitives straddling the children of a node are stored in that node; otherwise false.
+	*/
+	bool isLoose() const;
+
+	/**
+	* Sets whether the octree is loose. A loose octree stores primitives straddling the children of a node
+	* in that node, while a regular octree references them from every child they overlap.
+	* Takes effect the next time the octree is preprocessed.
+	* @param loose True to build a loose octree; otherwise false.
+	*/
+	void setLoose(bool loose);
 
 	/**
 	* Perform any necessary preprocessing.
@@ -18,25 +34,23 @@ public:
 	/*
 	* Returns whether any object is hit by the given ray and sets the intersection parameter
 	* to the RayIntersection representing the closest point of intersection.
-	* @param[in] origin The origin of the ray.
-	* @param[in] dir The direction of the ray.
+	* @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
 	* @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	* @return True if the ray intersected an object; otherwise false.
 	*/
-	bool calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const;
+	bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const;
 
 	/*
 	* Returns whether any object is hit by the given ray and sets the intersection parameter
 	* to the RayIntersection representing the point of intersection.
-	* @param[in] origin The origin of the ray.
-	* @param[in] dir The direction of the ray.
-	* @param maxDistance The maximum distance at which the intersection may occur.
+	* @param[in] ray The ray, only intersections within its interval are accepted.
 	* @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	* @return True if the ray intersected an object; otherwise false.
 	*/
-	bool calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const;
+	bool calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const;
 
 private:
+	bool loose;
 	OctreeNode *root;
 };
 
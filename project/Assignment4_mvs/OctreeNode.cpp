@@ -1,171 +1,294 @@
 #include <algorithm>
+#include <limits>
 
 #include "BoundingBox.h"
-#include "IGeometry.h"
 #include "OctreeNode.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 
+// The number of indices filtered by the mailbox at a time
+static const unsigned int MailboxBatchSize = 64;
+
+OctreeMailbox::OctreeMailbox() {
+	std::fill(this->entries, this->entries + Size, std::numeric_limits<unsigned int>::max());
+}
+
+unsigned int OctreeMailbox::removeTested(const unsigned int *indices, unsigned int count, unsigned int *untested) {
+	unsigned int untestedCount = 0;
+
+	for (unsigned int i = 0; i < count; i++) {
+		// Neighbouring primitives usually have consecutive indices and thus map to different entries
+		unsigned int &entry = this->entries[indices[i] & (Size - 1)];
+
+		if (entry != indices[i]) {
+			entry = indices[i];
+			untested[untestedCount++] = indices[i];
+		}
+	}
+
+	return untestedCount;
+}
+
 OctreeNode::OctreeNode() 
-: geometry(nullptr) {
+: primitives(nullptr), indices(nullptr) {
+	std::fill(this->children, this->children + 8, nullptr);
 }
 
-OctreeNode::OctreeNode(const std::vector<std::shared_ptr<IGeometry>> *geometry) 
-: OctreeNode(OctreeNode::createBoundingBox(geometry), geometry)
+OctreeNode::OctreeNode(const IPrimitiveSet *primitives, const std::vector<unsigned int> *indices, bool loose) 
+: OctreeNode(OctreeNode::createBoundingBox(primitives, indices), primitives, indices, loose)
 {
 }
 
-OctreeNode::OctreeNode(const BoundingBox &innerBox, const std::vector<std::shared_ptr<IGeometry>> *geometry) {
-	this->boundingBox = OctreeNode::createBoundingBox(geometry);
-	
-	if (geometry->size() > 32 && subdivide(innerBox, geometry, this->children)) {
-		this->geometry = nullptr;
+OctreeNode::OctreeNode(const BoundingBox &innerBox, const IPrimitiveSet *primitives, const std::vector<unsigned int> *indices, bool loose) 
+: primitives(primitives) {
+	this->boundingBox = OctreeNode::createBoundingBox(primitives, indices);
+	std::fill(this->children, this->children + 8, nullptr);
+
+	if (indices->size() > 32 && this->subdivide(innerBox, indices, loose)) {
+		this->center = innerBox.getCenter();
 
-		delete geometry;
+		delete indices;
 	}
 	else {
-		this->geometry = geometry;
+		this->indices = indices;
 	}
 }
 
 OctreeNode::~OctreeNode() {
-	if (this->geometry) {
-		delete this->geometry;
-		this->geometry = reinterpret_cast<const std::vector<std::shared_ptr<IGeometry>>*>(0xDEADBEEF);
-	}
-	else {
-		for (int i = 0; i < 8; i++) {
-			delete this->children[i];
-			this->children[i] = reinterpret_cast<OctreeNode*>(0xDEADBEEF);
-		}
+	delete this->indices;
+	this->indices = reinterpret_cast<const std::vector<unsigned int>*>(0xDEADBEEF);
+
+	for (int i = 0; i < 8; i++) {
+		delete this->children[i];
+		this->children[i] = reinterpret_cast<OctreeNode*>(0xDEADBEEF);
 	}
 }
 
-bool OctreeNode::calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const {
-	RayIntersection lastIntersection;
-	float distance;
+bool OctreeNode::calculateClosestIntersection(Ray &ray, RayIntersection &intersection, OctreeMailbox *mailbox) const {
+	float entryDistance;
+	float exitDistance;
 
-	// Intersect against the bounding box
-	if (!this->boundingBox.intersects(origin, dir, distance) || distance > intersection.distance)
+	// Intersect against the bounding box, the ray ends at the closest intersection so far
+	if (!this->boundingBox.intersects(ray, entryDistance, exitDistance))
 		return false;
 
-	bool intersectsAny = false;
+	// The intersection is only updated if a primitive is hit closer than the current best intersection
+	bool intersectsAny = this->calculateClosestPrimitiveIntersection(ray, intersection, mailbox);
 
-	if (this->geometry) {
-		for (unsigned int i = 0; i < this->geometry->size(); i++) {
-			bool intersects = this->geometry->at(i)->calculateClosestIntersection(origin, dir, lastIntersection);
+	if (!this->children[0])
+		return intersectsAny;
 
-			// If no intersection was found, continue
-			if (!intersects) {
-				continue;
-			}
+	// Find the distances at which the ray crosses the split planes and the child in which it enters the node
+	float splitDistances[3];
+	int pendingAxes = 0;
+	int child = 0;
 
-			// If this is the first intersection, set it intersection the the last intersection
-			if (!intersectsAny) {
-				intersectsAny = true;
-			}
+	for (int i = 0; i < 3; i++) {
+		splitDistances[i] = (this->center[i] - ray.origin[i]) * ray.invDirection[i];
 
-			// Set intersection to last intersection only if it is closer than the current best intersection
-			if (lastIntersection.distance < intersection.distance) {
-				intersection = lastIntersection;
-			}
+		// Before crossing a split plane the ray lies on the side it points away from.
+		// A ray parallel to the plane yields an infinite or NaN distance and never crosses it.
+		if (splitDistances[i] > entryDistance) {
+			child |= ray.sign[i] << i;
+			pendingAxes |= 1 << i;
+		}
+		else {
+			child |= (1 - ray.sign[i]) << i;
 		}
 	}
-	else {
-		for (int i = 0; i < 8; i++) {
-			bool intersects = this->children[i]->calculateClosestIntersection(origin, dir, intersection);
 
-			// If there is any intersection, set the intersectsAny flag
-			if (intersects) {
-				intersectsAny = true;
+	// Visit the children the ray passes through from front to back, the others are never entered
+	while (true) {
+		// The ray leaves the current child at the nearest split plane it has yet to cross
+		int axis = -1;
+		float childExitDistance = exitDistance;
+
+		for (int i = 0; i < 3; i++) {
+			if ((pendingAxes & (1 << i)) && splitDistances[i] < childExitDistance) {
+				childExitDistance = splitDistances[i];
+				axis = i;
 			}
 		}
+
+		if (this->children[child]->calculateClosestIntersection(ray, intersection, mailbox))
+			intersectsAny = true;
+
+		// Stop when the ray leaves the node, or when the closest intersection so far
+		// lies in front of the next child, which can then not contain a closer one
+		if (axis < 0 || ray.maxDistance < childExitDistance)
+			break;
+
+		pendingAxes &= ~(1 << axis);
+		child ^= 1 << axis;
 	}
 
 	return intersectsAny;
 }
 
-bool OctreeNode::calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const {
-	float distance;
-
+bool OctreeNode::calculateAnyIntersection(const Ray &ray, RayIntersection &intersection, OctreeMailbox *mailbox) const {
 	// Intersect against the bounding box
-	if (!this->boundingBox.intersects(origin, dir, distance) || distance > maxDistance)
+	if (!this->boundingBox.intersects(ray))
 		return false;
 
-	bool intersectsAny = false;
+	// Find the intersection between the ray and the primitives
+	if (this->calculateAnyPrimitiveIntersection(ray, intersection, mailbox))
+		return true;
 
-	if (this->geometry) {
-		for (unsigned int i = 0; i < this->geometry->size(); i++) {
-			// Find the intersection between the ray and the geometry
-			bool intersects = this->geometry->at(i)->calculateAnyIntersection(origin, dir, maxDistance, intersection);
+	if (!this->children[0])
+		return false;
 
-			// If an intersection was found, return it
-			if (intersects) {
-				return true;
-			}
+	for (int i = 0; i < 8; i++) {
+		// Find the intersection between the ray and the geometry
+		bool intersects = this->children[i]->calculateAnyIntersection(ray, intersection, mailbox);
+
+		// If an intersection was found, return it
+		if (intersects) {
+			return true;
 		}
 	}
-	else {
-		for (int i = 0; i < 8; i++) {
-			// Find the intersection between the ray and the geometry
-			bool intersects = this->children[i]->calculateAnyIntersection(origin, dir, maxDistance, intersection);
 
-			// If an intersection was found, return it
-			if (intersects) {
-				return true;
-			}
-		}
+	return false;
+}
+
+bool OctreeNode::calculateClosestPrimitiveIntersection(Ray &ray, RayIntersection &intersection, OctreeMailbox *mailbox) const {
+	if (!this->indices || this->indices->empty())
+		return false;
+
+	const unsigned int *indices = &this->indices->at(0);
+	unsigned int count = this->indices->size();
+
+	if (!mailbox)
+		return this->primitives->calculateClosestIntersection(indices, count, ray, intersection);
+
+	unsigned int untested[MailboxBatchSize];
+	bool intersectsAny = false;
+
+	// Skip the primitives which were already intersected in another leaf. If such a primitive was hit,
+	// the ray already ends at that intersection, so nothing is lost.
+	for (unsigned int i = 0; i < count; i += MailboxBatchSize) {
+		unsigned int untestedCount = mailbox->removeTested(indices + i, std::min(count - i, MailboxBatchSize), untested);
+
+		if (untestedCount > 0 && this->primitives->calculateClosestIntersection(untested, untestedCount, ray, intersection))
+			intersectsAny = true;
+	}
+
+	return intersectsAny;
+}
+
+bool OctreeNode::calculateAnyPrimitiveIntersection(const Ray &ray, RayIntersection &intersection, OctreeMailbox *mailbox) const {
+	if (!this->indices || this->indices->empty())
+		return false;
+
+	const unsigned int *indices = &this->indices->at(0);
+	unsigned int count = this->indices->size();
+
+	if (!mailbox)
+		return this->primitives->calculateAnyIntersection(indices, count, ray, intersection);
+
+	unsigned int untested[MailboxBatchSize];
+
+	// Skip the primitives which were already intersected in another leaf
+	for (unsigned int i = 0; i < count; i += MailboxBatchSize) {
+		unsigned int untestedCount = mailbox->removeTested(indices + i, std::min(count - i, MailboxBatchSize), untested);
+
+		if (untestedCount > 0 && this->primitives->calculateAnyIntersection(untested, untestedCount, ray, intersection))
+			return true;
 	}
 
 	return false;
 }
 
-bool OctreeNode::subdivide(const BoundingBox &boundingBox, const std::vector<std::shared_ptr<IGeometry>> *geometry, OctreeNode *children[8]) {
+bool OctreeNode::subdivide(const BoundingBox &boundingBox, const std::vector<unsigned int> *indices, bool loose) {
 	BoundingBox childBoxes[8];
-	std::vector<std::shared_ptr<IGeometry>> *childData[8];
+	std::vector<unsigned int> *childData[8];
+	std::vector<unsigned int> *straddling = new std::vector<unsigned int>();
 
 	// Compute the bounding boxes of the children
 	OctreeNode::createChildBoundingBoxes(boundingBox, childBoxes);
 
+	for (int i = 0; i < 8; i++) {
+		childData[i] = new std::vector<unsigned int>();
+	}
+
 	unsigned int biggestChild = 0;
 	unsigned int totalIntersectionTests = 8;
 
-	// Create an array of intersecting geometry for each bounding box and count the total number of
-	// intersection tests required for the given geometry set after subdividing.
-	for (int i = 0; i < 8; i++) {
-		childData[i] = new std::vector<std::shared_ptr<IGeometry>>();
-		unsigned int child = 0;
+	if (loose) {
+		// Hand each primitive to the child containing it, primitives straddling the children stay in this node
+		for (unsigned int j = 0; j < indices->size(); j++) {
+			BoundingBox box = this->primitives->getBoundingBox(indices->at(j));
+			int i = 0;
 
-		for (unsigned int j = 0; j < geometry->size(); j++) {
-			if (childBoxes[i].intersects(geometry->at(j)->getBoundingBox())) {
-				childData[i]->push_back(geometry->at(j));
+			while (i < 8 && !childBoxes[i].contains(box))
+				i++;
 
-				totalIntersectionTests++;
-				child++;
-			}
+			if (i < 8)
+				childData[i]->push_back(indices->at(j));
+			else
+				straddling->push_back(indices->at(j));
 		}
 
-		biggestChild = std::max(biggestChild, child);
+		for (int i = 0; i < 8; i++) {
+			biggestChild = std::max<unsigned int>(biggestChild, childData[i]->size());
+		}
+	}
+	else {
+		// Create an array of intersecting primitives for each bounding box and count the total number of
+		// intersection tests required for the given primitive set after subdividing.
+		for (int i = 0; i < 8; i++) {
+			unsigned int child = 0;
+
+			for (unsigned int j = 0; j < indices->size(); j++) {
+				if (childBoxes[i].intersects(this->primitives->getBoundingBox(indices->at(j)))) {
+					childData[i]->push_back(indices->at(j));
+
+					totalIntersectionTests++;
+					child++;
+				}
+			}
+
+			biggestChild = std::max(biggestChild, child);
+		}
 	}
 
 	// Some arbitary heuristic, if the total number of intersection tests increases by more
-	// than a factor of two, do not subdivide.
-	if ((biggestChild > geometry->size() / 4) || (totalIntersectionTests > 2 * geometry->size()))
+	// than a factor of two, do not subdivide. A loose node is not subdivided if most of its
+	// primitives straddle the children or if they all end up in the same child.
+	bool worthwhile = loose ?
+		(straddling->size() <= indices->size() / 2 && biggestChild < indices->size()) :
+		(biggestChild <= indices->size() / 4 && totalIntersectionTests <= 2 * indices->size());
+
+	if (!worthwhile) {
+		for (int i = 0; i < 8; i++) {
+			delete childData[i];
+		}
+
+		delete straddling;
+
 		return false;
+	}
 
 	// Otherwise create the eight children bounding boxes.
 	for (int i = 0; i < 8; i++) {
-		children[i] = new OctreeNode(childData[i]);
+		this->children[i] = new OctreeNode(this->primitives, childData[i], loose);
 	}
 
+	if (straddling->empty()) {
+		delete straddling;
+		straddling = nullptr;
+	}
+
+	this->indices = straddling;
+
 	return true;
 }
 
-BoundingBox OctreeNode::createBoundingBox(const std::vector<std::shared_ptr<IGeometry>> *geometry) {
+BoundingBox OctreeNode::createBoundingBox(const IPrimitiveSet *primitives, const std::vector<unsigned int> *indices) {
 	BoundingBox result = BoundingBox();
 	BoundingBox box;
 
-	for (unsigned int i = 0; i < geometry->size(); i++)  {
-		box = geometry->at(i)->getBoundingBox();
+	for (unsigned int i = 0; i < indices->size(); i++)  {
+		box = primitives->getBoundingBox(indices->at(i));
 
 		result.includePoint(box.min);
 		result.includePoint(box.max);
@@ -175,49 +298,16 @@ BoundingBox OctreeNode::createBoundingBox(const std::vector<std::shared_ptr<IGeo
 }
 
 void OctreeNode::createChildBoundingBoxes(const BoundingBox &box, BoundingBox children[8]) {
-	// 0 = (-1,-1,-1), ( 0, 0, 0)
-	// 1 = ( 0,-1,-1), ( 1, 0, 0)
-	// 3 = (-1, 0,-1), ( 0, 1, 0)
-	// 2 = ( 0, 0,-1), ( 1, 1, 0)
-	// 7 = (-1,-1, 0), ( 0, 0, 1)
-	// 6 = ( 0,-1, 0), ( 1, 0, 1)
-	// 4 = (-1, 0, 0), ( 0, 1, 1)
-	// 5 = ( 0, 0, 0), ( 1, 1, 1)
-
-	Vec3Df max = box.max;
-	Vec3Df min = box.min;
 	Vec3Df mid = box.getCenter();
-	BoundingBox temp;
-
-	temp.min = min;
-	temp.max = mid;
-	children[0] = temp;
-
-	temp.min[0] = mid[0];
-	temp.max[0] = max[0];
-	children[1] = temp;
-
-	temp.min[1] = mid[1];
-	temp.max[1] = max[1];
-	children[3] = temp;
-
-	temp.min[0] = min[0];
-	temp.max[0] = mid[0];
-	children[2] = temp;
 
-	temp.min[2] = mid[2];
-	temp.max[2] = max[2];
-	children[7] = temp;
-
-	temp.min[0] = mid[0];
-	temp.max[0] = max[0];
-	children[6] = temp;
-
-	temp.min[1] = min[1];
-	temp.max[1] = mid[1];
-	children[4] = temp;
+	// Each bit of the index of a child selects the upper half of the box along an axis,
+	// bit 0 for the x-axis, bit 1 for the y-axis and bit 2 for the z-axis
+	for (int i = 0; i < 8; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			bool upper = (i & (1 << axis)) != 0;
 
-	temp.min[0] = min[0];
-	temp.max[0] = mid[0];
-	children[5] = temp;
+			children[i].min[axis] = upper ? mid[axis] : box.min[axis];
+			children[i].max[axis] = upper ? box.max[axis] : mid[axis];
+		}
+	}
 }
\ No newline at end of file
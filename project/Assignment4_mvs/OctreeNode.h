@@ -4,35 +4,63 @@
 #include <vector>
 
 #include "BoundingBox.h"
-#include "IGeometry.h"
+#include "IPrimitiveSet.h"
+
+/**
+ * Remembers which primitives were already intersected with a ray, so that primitives
+ * referenced by several leaves of an octree are not intersected again by the same ray.
+ *
+ * The indices are hashed into a small direct mapped table, a collision only evicts an entry
+ * and causes that primitive to be intersected again. A mailbox is used for a single ray.
+ */
+class OctreeMailbox {
+public:
+	/**
+	 * Initializes an empty mailbox.
+	 */
+	OctreeMailbox();
+
+	/**
+	 * Copies the given indices which were not intersected yet to untested and marks them as intersected.
+	 * @param[in] indices The indices of the primitives.
+	 * @param count The number of indices.
+	 * @param[out] untested Array of at least count elements receiving the indices which were not intersected yet.
+	 * @return The number of indices copied to untested.
+	 */
+	unsigned int removeTested(const unsigned int *indices, unsigned int count, unsigned int *untested);
+
+private:
+	static const unsigned int Size = 64;
+
+	unsigned int entries[Size];
+};
 
 class OctreeNode {
 public:
 	OctreeNode();
-	OctreeNode(const std::vector<std::shared_ptr<IGeometry>> *geometry);
-	OctreeNode(const BoundingBox &innerBox, const std::vector<std::shared_ptr<IGeometry>> *geometry);
+	OctreeNode(const IPrimitiveSet *primitives, const std::vector<unsigned int> *indices, bool loose);
+	OctreeNode(const BoundingBox &innerBox, const IPrimitiveSet *primitives, const std::vector<unsigned int> *indices, bool loose);
 	~OctreeNode();
 
 	/*
 	* Returns whether any object is hit by the given ray and sets the intersection parameter
 	* to the RayIntersection representing the closest point of intersection.
-	* @param[in] origin The origin of the ray.
-	* @param[in] dir The direction of the ray.
+	* @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
 	* @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	* @param mailbox The mailbox of the ray, or nullptr if every primitive is referenced by a single node.
 	* @return True if the ray intersected an object; otherwise false.
 	*/
-	bool calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const;
+	bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection, OctreeMailbox *mailbox) const;
 
 	/*
 	* Returns whether any object is hit by the given ray and sets the intersection parameter
 	* to the RayIntersection representing the point of intersection.
-	* @param[in] origin The origin of the ray.
-	* @param[in] dir The direction of the ray.
-	* @param maxDistance The maximum distance at which the intersection may occur.
+	* @param[in] ray The ray, only intersections within its interval are accepted.
 	* @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	* @param mailbox The mailbox of the ray, or nullptr if every primitive is referenced by a single node.
 	* @return True if the ray intersected an object; otherwise false.
 	*/
-	bool calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const;
+	bool calculateAnyIntersection(const Ray &ray, RayIntersection &intersection, OctreeMailbox *mailbox) const;
 
 private:
 	/**
@@ -41,22 +69,42 @@ private:
 	static void createChildBoundingBoxes(const BoundingBox &box, BoundingBox children[8]);
 
 	/**
-	 * Creates a box bounding the given geometry.
+	 * Creates a box bounding the given primitives.
+	 */
+	static BoundingBox createBoundingBox(const IPrimitiveSet *primitives, const std::vector<unsigned int> *indices);
+
+	/**
+	 * Tries to distribute the given primitives over 8 children and sets the children and indices of this node if that pays off.
+	 * @param[in] boundingBox The bounding box which is split into the boxes of the children.
+	 * @param[in] indices The indices of the primitives.
+	 * @param loose Whether primitives straddling the boxes of the children are kept in this node,
+	 * rather than being referenced by every child they overlap.
+	 * @return True if the node was subdivided; otherwise false.
+	 */
+	bool subdivide(const BoundingBox &boundingBox, const std::vector<unsigned int> *indices, bool loose);
+
+	/**
+	 * Intersects the primitives referenced by this node which were not yet intersected with the ray.
 	 */
-	static BoundingBox createBoundingBox(const std::vector<std::shared_ptr<IGeometry>> *geometry);
+	bool calculateClosestPrimitiveIntersection(Ray &ray, RayIntersection &intersection, OctreeMailbox *mailbox) const;
 
 	/**
-	 *
-	 * @param[in] boundingBox
-	 * @param[in] geometry
-	 * @param[out] children
-	 * @return
+	 * Intersects the primitives referenced by this node which were not yet intersected with the ray.
 	 */
-	static bool subdivide(const BoundingBox &boundingBox, const std::vector<std::shared_ptr<IGeometry>> *geometry, OctreeNode *children[8]);
+	bool calculateAnyPrimitiveIntersection(const Ray &ray, RayIntersection &intersection, OctreeMailbox *mailbox) const;
 
 	BoundingBox boundingBox;
+
+	// The point at which the split planes of an inner node intersect
+	Vec3Df center;
+
+	// Each bit of the index of a child selects the upper half along an axis, bit 0 for the x-axis.
+	// The children of a leaf are nullptr.
 	OctreeNode *children[8];
-	const std::vector<std::shared_ptr<IGeometry>> *geometry;
+	const IPrimitiveSet *primitives;
+
+	// The primitives referenced by a leaf, or those straddling the children of an inner node of a loose octree
+	const std::vector<unsigned int> *indices;
 };
 
 #endif
\ No newline at end of file
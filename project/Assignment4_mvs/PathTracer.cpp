@@ -0,0 +1,329 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "Constants.h"
+#include "IGeometry.h"
+#include "ILight.h"
+#include "LightTree.h"
+#include "PathTracer.h"
+#include "Random.h"
+#include "Ray.h"
+#include "RayIntersection.h"
+#include "Scene.h"
+#include "SurfacePoint.h"
+
+namespace {
+	/**
+	 * The continuations of a path at a surface.
+	 */
+	enum Lobe {
+		BRDFLobe,
+		SpecularLobe,
+		TransmittedLobe,
+		LobeCount
+	};
+
+	float getAverage(const Vec3Df &color) {
+		return (color[0] + color[1] + color[2]) * (1.0f / 3.0f);
+	}
+
+	float getMaximum(const Vec3Df &color) {
+		return std::max(color[0], std::max(color[1], color[2]));
+	}
+}
+
+PathTracer::PathTracer()
+: rouletteDepth(DefaultRouletteDepth), maxDepth(DefaultMaxDepth) {
+}
+
+int PathTracer::getRouletteDepth() const {
+	return this->rouletteDepth;
+}
+
+int PathTracer::getMaxDepth() const {
+	return this->maxDepth;
+}
+
+void PathTracer::setRouletteDepth(int depth) {
+	assert(depth >= 0);
+
+	this->rouletteDepth = depth;
+}
+
+void PathTracer::setMaxDepth(int depth) {
+	assert(depth >= 1);
+
+	this->maxDepth = depth;
+}
+
+Vec3Df PathTracer::performRayTracingIteration(
+	const Vec3Df &origin,
+	const Vec3Df &dir,
+	int iteration,
+	float &distance) const
+{
+	return this->tracePath(origin, dir, iteration, false, distance);
+}
+
+Vec3Df PathTracer::tracePath(
+	const Vec3Df &origin,
+	const Vec3Df &dir,
+	int iteration,
+	bool isIndirect,
+	float &distance) const
+{
+	// Get a pointer to the scene.
+	const Scene *scene = this->getScene();
+
+	assert(scene);
+
+	// Paths computing a record of the irradiance cache do not use the cache themselves
+	bool useCache = !isIndirect && scene->getIrradianceCacheEnabled();
+
+	Vec3Df radiance = Vec3Df();
+	Vec3Df throughput = Vec3Df(1.0f, 1.0f, 1.0f);
+
+	// The absorbance of the medium the path currently travels through
+	Vec3Df absorbance = Vec3Df();
+
+	// The previous surface of the path and the density with which the BRDFs sampled the direction leaving it,
+	// which is zero for camera rays, mirror reflections and refractions as lights cannot be sampled along those
+	Vec3Df previousPoint = origin;
+	const IGeometry *previousGeometry = nullptr;
+	float previousDensity = 0.0f;
+
+	Ray ray(origin, dir);
+
+	for (int depth = iteration; depth < this->maxDepth; depth++) {
+		RayIntersection intersection;
+
+		if (!scene->calculateClosestIntersection(ray, intersection))
+			break;
+
+		if (depth == iteration)
+			distance = intersection.distance;
+
+		// Absorb light along the segment using beer's law
+		if (absorbance.getSquaredLength() > 0.0f) {
+			throughput[0] *= expf(-absorbance[0] * intersection.distance);
+			throughput[1] *= expf(-absorbance[1] * intersection.distance);
+			throughput[2] *= expf(-absorbance[2] * intersection.distance);
+		}
+
+		// Get the surface point at the intersection point, this contains surface parameters useful for shading.
+		SurfacePoint surface;
+		intersection.getSurfacePoint(surface);
+
+		// The 'view' vector is the opposite of the ray direction
+		Vec3Df viewVector = -intersection.direction;
+		Vec3Df emitted = surface.emittedLight(viewVector);
+		bool isEmissive = emitted[0] != 0.0f || emitted[1] != 0.0f || emitted[2] != 0.0f;
+
+		if (isEmissive) {
+			// Light sources are seen as they are, but the light they shed on other surfaces is that of the light.
+			// Indirect paths start at a surface that sampled the lights on its own, so they skip the lights they hit first.
+			const ILight *light = depth > iteration || isIndirect ? scene->getLightTree()->findLight(intersection.geometry) : nullptr;
+			Vec3Df lightColor;
+			float lightDensity;
+
+			if (!light) {
+				radiance += throughput * emitted;
+			}
+			else if (depth > iteration && light->evaluateLight(previousPoint, surface, lightColor, lightDensity)) {
+				float weight = 1.0f;
+
+				// The previous surface sampled this light as well, weigh both strategies
+				if (previousDensity > 0.0f && light->getGeometry().get() != previousGeometry) {
+					float lightRate = this->calculateLightChoiceRate(light, previousPoint) * this->getLightSampleCount(light);
+
+					weight = PathTracer::calculatePowerHeuristic(previousDensity, lightRate * lightDensity);
+				}
+
+				radiance += throughput * lightColor * weight;
+			}
+		}
+
+		// Diffuse surfaces interpolate the indirect light they receive from the irradiance cache instead of continuing the path
+		bool isCached = useCache && !isEmissive && surface.isDiffuse();
+
+		// Add the ambient light and the light arriving directly from the light sources
+		radiance += throughput * (surface.ambientLight(scene) + this->sampleLights(intersection, surface, !isCached));
+
+		if (isCached)
+			radiance += throughput * surface.diffuseLight(viewVector, this->calculateIrradiance(surface, depth)) / Constants::Pi;
+
+		// Find the continuations of the path and the fraction of the light along each that is reflected towards the view vector.
+		// The BRDFs are always sampled, so every bounce draws the same random dimensions.
+		Vec3Df directions[LobeCount];
+		Vec3Df weights[LobeCount];
+		Vec3Df absorbances[LobeCount];
+		float probabilities[LobeCount] = { 0.0f, 0.0f, 0.0f };
+
+		directions[BRDFLobe] = surface.sampleIncomingVector(viewVector);
+		float density = surface.getProbabilityDensity(directions[BRDFLobe], viewVector);
+
+		// Light sources do not reflect through their BRDFs, like in the whitted-style ray tracer
+		if (!isEmissive && !isCached && density > 0.0f && Vec3Df::dotProduct(directions[BRDFLobe], surface.normal) > 0.0f) {
+			weights[BRDFLobe] = surface.reflectedLight(directions[BRDFLobe], viewVector, Vec3Df(1.0f, 1.0f, 1.0f)) / (Constants::Pi * density);
+			probabilities[BRDFLobe] = getAverage(weights[BRDFLobe]);
+			absorbances[BRDFLobe] = absorbance;
+		}
+
+		if (surface.calculateSpecularRay(viewVector, directions[SpecularLobe], weights[SpecularLobe])) {
+			probabilities[SpecularLobe] = getAverage(weights[SpecularLobe]);
+			absorbances[SpecularLobe] = absorbance;
+		}
+
+		if (surface.calculateTransmittedRay(viewVector, directions[TransmittedLobe], weights[TransmittedLobe], absorbances[TransmittedLobe])) {
+			probabilities[TransmittedLobe] = getAverage(weights[TransmittedLobe]);
+
+			// Leaving an object the path returns to the air, which does not absorb any light
+			if (surface.isInside)
+				absorbances[TransmittedLobe] = Vec3Df();
+		}
+
+		// Choose a continuation in proportion to the light it carries
+		float total = probabilities[BRDFLobe] + probabilities[SpecularLobe] + probabilities[TransmittedLobe];
+		float choice = Random::randUnit() * total;
+		float survival = Random::randUnit();
+
+		if (total <= 0.0f)
+			break;
+
+		int lobe = BRDFLobe;
+
+		while (lobe < LobeCount - 1 && (probabilities[lobe] == 0.0f || choice >= probabilities[lobe])) {
+			choice -= probabilities[lobe];
+			lobe++;
+		}
+
+		// Guard against rounding selecting a continuation that carries no light
+		if (probabilities[lobe] == 0.0f)
+			break;
+
+		throughput *= weights[lobe] * (total / probabilities[lobe]);
+
+		// Terminate the path by russian roulette, surviving paths carry the light of the terminated ones
+		if (depth + 1 - iteration >= this->rouletteDepth) {
+			float probability = std::min(1.0f, getMaximum(throughput));
+
+			if (survival >= probability)
+				break;
+
+			throughput /= probability;
+		}
+
+		previousPoint = surface.point;
+		previousGeometry = intersection.geometry;
+		previousDensity = lobe == BRDFLobe ? density : 0.0f;
+
+		ray = Ray(surface.point + directions[lobe] * Constants::Epsilon, directions[lobe]);
+		absorbance = absorbances[lobe];
+	}
+
+	return radiance;
+}
+
+Vec3Df PathTracer::sampleLights(const RayIntersection &intersection, const SurfacePoint &surface, bool weighBRDFs) const {
+	// Sums the light reflected from every chosen light as it is chosen
+	class SampledLightVisitor : public LightVisitor {
+	public:
+		SampledLightVisitor(const PathTracer *pathTracer, const RayIntersection &intersection, const SurfacePoint &surface, bool weighBRDFs) :
+		intersection(intersection),
+		lighting(Vec3Df()),
+		pathTracer(pathTracer),
+		surface(surface),
+		weighBRDFs(weighBRDFs) {
+		}
+
+		void visitLight(const ILight *light, float weight) {
+			this->lighting += this->pathTracer->sampleLight(this->intersection, this->surface, light, weight, this->weighBRDFs) * weight;
+		}
+
+		const RayIntersection &intersection;
+		Vec3Df lighting;
+		const PathTracer *pathTracer;
+		const SurfacePoint &surface;
+		bool weighBRDFs;
+	};
+
+	SampledLightVisitor visitor(this, intersection, surface, weighBRDFs);
+	this->chooseLights(surface.point, visitor);
+
+	return visitor.lighting;
+}
+
+Vec3Df PathTracer::sampleLight(const RayIntersection &intersection, const SurfacePoint &surface, const ILight *light, float lightWeight, bool weighBRDFs) const {
+	// The 'view' vector is the opposite of the ray direction
+	Vec3Df viewVector = -intersection.direction;
+	Vec3Df lightContribution = Vec3Df();
+
+	// A light does not illuminate itself
+	if (light->getGeometry().get() == intersection.geometry)
+		return lightContribution;
+
+	int lightSamples = this->getLightSampleCount(light);
+
+	// Stratify the samples of the light
+	unsigned int lightSeed = Random::rand();
+
+	for (int i = 0; i < lightSamples; i++) {
+		Vec3Df lightPoint;
+		Vec3Df lightColor;
+		float lightDensity;
+
+		// Sample the light for a position, color and density
+		float u, v;
+		Random::sampleStratifiedSquare(i, lightSeed, u, v);
+
+		if (!light->sampleLight(surface.point, u, v, lightPoint, lightColor, lightDensity))
+			continue;
+
+		// Compute the vector from the intersection towards the light
+		Vec3Df lightVector = lightPoint - surface.point;
+		float lightDistance = lightVector.normalize();
+
+		// Light from below the surface is not reflected
+		if (Vec3Df::dotProduct(lightVector, surface.normal) <= 0.0f)
+			continue;
+
+		if (this->isShadowed(surface.point, lightVector, lightDistance))
+			continue;
+
+		Vec3Df reflected = surface.reflectedLight(lightVector, viewVector, lightColor) / Constants::Pi;
+
+		if (lightDensity > 0.0f) {
+			// Weigh the sample against sampling the BRDFs, which could have found the same light point
+			float weight = 1.0f;
+
+			if (weighBRDFs) {
+				float density = surface.getProbabilityDensity(lightVector, viewVector);
+				weight = PathTracer::calculatePowerHeuristic(lightSamples / lightWeight * lightDensity, density);
+			}
+
+			lightContribution += reflected * (weight / lightDensity);
+		}
+		else {
+			// Lights without geometry can only be found by sampling them
+			lightContribution += reflected;
+		}
+	}
+
+	return lightContribution / (float)lightSamples;
+}
+
+Vec3Df PathTracer::traceIndirectRay(const Vec3Df &origin, const Vec3Df &dir, int iteration, float &distance) const {
+	// The lights are sampled by the surface itself, so the path skips the light sources it hits first
+	return this->tracePath(origin, dir, iteration + 1, true, distance);
+}
+
+float PathTracer::calculatePowerHeuristic(float density, float otherDensity) {
+	float squaredDensity = density * density;
+	float squaredOtherDensity = otherDensity * otherDensity;
+
+	if (squaredDensity + squaredOtherDensity <= 0.0f)
+		return 0.0f;
+
+	return squaredDensity / (squaredDensity + squaredOtherDensity);
+}
\ No newline at end of file
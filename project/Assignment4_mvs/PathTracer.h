@@ -0,0 +1,156 @@
+#ifndef PATHTRACER_H
+#define PATHTRACER_H
+
+#include "IRayTracer.h"
+
+class ILight;
+
+/**
+ * Implements an iterative path tracer.
+ *
+ * Instead of recursing into every reflected and transmitted ray, a single path is followed in a loop.
+ * At every surface one of the diffuse, specular and transmitted continuations is chosen at random in proportion
+ * to the light it carries, and the throughput of the path, the fraction of the light at the current surface
+ * that reaches the camera, is divided by the probability of the choice. After a number of bounces paths are
+ * terminated by Russian roulette with a probability based on their throughput, and the throughput of surviving paths
+ * is divided by the probability of survival. Paths thus have no fixed length while their expected value is unchanged,
+ * and dim paths, which contribute little, are cheap.
+ *
+ * Reflected directions are sampled from the BRDFs, cosine-weighted for diffuse BRDFs and following the lobe of
+ * glossy ones. At every surface the lights are sampled as well, and light that could have been found by both strategies
+ * is weighed by multiple importance sampling with the power heuristic. The light reflected by a BRDF for light arriving
+ * over a solid angle is reflectedLight / pi, so a white Lambertian surface reflects all light it receives.
+ *
+ * When the scene caches irradiance, diffuse surfaces do not continue the path along their BRDF. Instead they interpolate
+ * the indirect light they receive from the records of the irradiance cache, and where no record is valid one is computed
+ * by tracing indirect paths through a stratified hemisphere. The light sources are then only found by sampling them.
+ * Records are shared by all pixels and threads, so each hemisphere of paths replaces the indirect paths of many pixels.
+ *
+ * The maximum trace depth of the scene is not used, diffuse reflections are always traced.
+ */
+class PathTracer : public IRayTracer {
+public:
+	/**
+	 * The default number of bounces after which Russian roulette starts.
+	 */
+	static const int DefaultRouletteDepth = 3;
+
+	/**
+	 * The default maximum number of bounces, which only guards against paths that never lose any light.
+	 */
+	static const int DefaultMaxDepth = 64;
+
+	/**
+	 * Initializes a PathTracer with the default roulette and maximum depths.
+	 */
+	PathTracer();
+
+	/**
+	 * Gets the number of bounces after which paths are terminated by Russian roulette.
+	 * @return The number of bounces after which Russian roulette starts.
+	 */
+	int getRouletteDepth() const;
+
+	/**
+	 * Gets the maximum number of bounces of a path.
+	 * @return The maximum number of bounces of a path.
+	 */
+	int getMaxDepth() const;
+
+	/**
+	 * Sets the number of bounces after which paths are terminated by Russian roulette.
+	 * @param depth The number of bounces after which Russian roulette starts.
+	 */
+	void setRouletteDepth(int depth);
+
+	/**
+	 * Sets the maximum number of bounces of a path. Paths are cut off at this depth,
+	 * which darkens the image unless Russian roulette terminates nearly all paths before.
+	 * @param depth The maximum number of bounces of a path.
+	 */
+	void setMaxDepth(int depth);
+
+	/**
+	* Performs a ray tracing iteration.
+	*
+	* Traces a path starting with the given ray through the scene and returns the light reflected backwards the ray.
+	*
+	* @param[in] origin	The origin of the ray.
+	* @param[in] dir		The direction of the ray.
+	* @param[in] iteration	The current iteration, which counts towards the roulette and maximum depths.
+	* @param[out] distance	The distance to the closest surface hit by the ray.
+	* @return The light towards the given ray.
+	*/
+	Vec3Df performRayTracingIteration(
+		const Vec3Df &origin,
+		const Vec3Df &dir,
+		int iteration,
+		float &distance) const;
+
+protected:
+	/**
+	 * Traces an indirect path from a surface whose irradiance is being calculated.
+	 *
+	 * @param[in] origin	The origin of the ray.
+	 * @param[in] dir		The direction of the ray.
+	 * @param[in] iteration	The iteration of the surface the ray leaves.
+	 * @param[out] distance	The distance to the closest surface hit by the ray.
+	 * @return The light towards the given ray, without the light sources it hits first.
+	 */
+	Vec3Df traceIndirectRay(const Vec3Df &origin, const Vec3Df &dir, int iteration, float &distance) const;
+
+private:
+	/**
+	 * Traces a path starting with the given ray through the scene and returns the light reflected backwards the ray.
+	 *
+	 * @param[in] origin	The origin of the ray.
+	 * @param[in] dir		The direction of the ray.
+	 * @param[in] iteration	The current iteration, which counts towards the roulette and maximum depths.
+	 * @param isIndirect	Whether the ray leaves a surface that sampled the lights without weighing them against its BRDFs,
+	 *						in which case the light sources it hits first are skipped. Indirect paths do not use the irradiance cache.
+	 * @param[out] distance	The distance to the closest surface hit by the ray.
+	 * @return The light towards the given ray.
+	 */
+	Vec3Df tracePath(
+		const Vec3Df &origin,
+		const Vec3Df &dir,
+		int iteration,
+		bool isIndirect,
+		float &distance) const;
+
+	/**
+	 * Samples the lights of the scene and calculates the light reflected towards the ray from the point of intersection.
+	 *
+	 * @param[in] intersection	The intersection point to shade.
+	 * @param[in] surface		The surface point at the intersection.
+	 * @param weighBRDFs		Whether to weigh the samples against sampling the BRDFs, which is only done if the path continues along them.
+	 * @return The light reflected directly from the light sources towards the ray.
+	 */
+	Vec3Df sampleLights(const RayIntersection &intersection, const SurfacePoint &surface, bool weighBRDFs) const;
+
+	/**
+	 * Samples the given light and calculates the light reflected towards the ray from the point of intersection.
+	 *
+	 * @param[in] intersection	The intersection point to shade.
+	 * @param[in] surface		The surface point at the intersection.
+	 * @param[in] light			The light.
+	 * @param lightWeight		The factor by which the contribution of the light is multiplied.
+	 * @param weighBRDFs		Whether to weigh the samples against sampling the BRDFs.
+	 * @return The light reflected directly from the light towards the ray.
+	 */
+	Vec3Df sampleLight(const RayIntersection &intersection, const SurfacePoint &surface, const ILight *light, float lightWeight, bool weighBRDFs) const;
+
+	/**
+	 * Calculates the weight of a sample taken with the given density by the power heuristic
+	 * when the same sample can be taken with the other density as well.
+	 * @param density The density of the strategy that took the sample, multiplied by its number of samples.
+	 * @param otherDensity The density of the other strategy, multiplied by its number of samples.
+	 * @return The weight of the sample.
+	 */
+	static float calculatePowerHeuristic(float density, float otherDensity);
+
+	int rouletteDepth;
+	int maxDepth;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <cmath>
+
+#include "PixelEstimator.h"
+
+// The luminance below which the error of a pixel is judged relative to this value instead
+static const float MinLuminance = 0.01f;
+
+// The number of standard errors spanned by half of the 95% confidence interval
+static const float ConfidenceScale = 1.96f;
+
+PixelEstimator::PixelEstimator()
+: sampleCount(0), meanLuminance(0.0f), squaredDeviations(0.0f) {
+}
+
+void PixelEstimator::addSample(const Vec3Df &color) {
+	float luminance = 0.2126f * color[0] + 0.7152f * color[1] + 0.0722f * color[2];
+
+	this->sampleCount++;
+
+	// Welford's update, the deviations before and after updating the mean give the sum of squared deviations
+	float delta = luminance - this->meanLuminance;
+	this->meanLuminance += delta / this->sampleCount;
+	this->squaredDeviations += delta * (luminance - this->meanLuminance);
+
+	this->mean += (color - this->mean) / (float)this->sampleCount;
+}
+
+int PixelEstimator::getSampleCount() const {
+	return this->sampleCount;
+}
+
+const Vec3Df &PixelEstimator::getMean() const {
+	return this->mean;
+}
+
+float PixelEstimator::getVariance() const {
+	if (this->sampleCount < 2)
+		return 0.0f;
+
+	return this->squaredDeviations / (this->sampleCount - 1);
+}
+
+bool PixelEstimator::hasConverged(float threshold) const {
+	if (this->sampleCount < 2)
+		return false;
+
+	float halfWidth = ConfidenceScale * std::sqrt(this->getVariance() / this->sampleCount);
+
+	return halfWidth <= threshold * std::max(this->meanLuminance, MinLuminance);
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef PIXELESTIMATOR_H
+#define PIXELESTIMATOR_H
+
+#include "Vec3D.h"
+
+/**
+ * Estimates the color of a pixel from a stream of samples.
+ *
+ * Keeps the running mean of the color and the running mean and variance of its luminance,
+ * which are updated with Welford's algorithm so they stay accurate for any number of samples.
+ * The variance is used to decide whether the estimate has converged.
+ */
+class PixelEstimator {
+public:
+	/**
+	 * Initializes an estimator without any samples.
+	 */
+	PixelEstimator();
+
+	/**
+	 * Adds a sample to the estimate.
+	 * @param[in] color The color of the sample.
+	 */
+	void addSample(const Vec3Df &color);
+
+	/**
+	 * Gets the number of samples added so far.
+	 * @return The number of samples added so far.
+	 */
+	int getSampleCount() const;
+
+	/**
+	 * Gets the mean color of the samples.
+	 * @return The mean color of the samples, or black if there are none.
+	 */
+	const Vec3Df &getMean() const;
+
+	/**
+	 * Gets the sample variance of the luminance of the samples.
+	 * @return The sample variance of the luminance, or zero if there are fewer than two samples.
+	 */
+	float getVariance() const;
+
+	/**
+	 * Tests whether the estimate has converged, which is the case when the 95% confidence interval of the
+	 * mean luminance is narrower than the given fraction of the mean luminance.
+	 * Dark pixels are compared against a minimum luminance, as their absolute error is hardly visible.
+	 * @param threshold The maximum relative half-width of the confidence interval.
+	 * @return True if there are at least two samples and the estimate has converged; otherwise false.
+	 */
+	bool hasConverged(float threshold) const;
+
+private:
+	int sampleCount;
+	Vec3Df mean;
+	float meanLuminance;
+	float squaredDeviations;
+};
+
+#endif
\ No newline at end of file
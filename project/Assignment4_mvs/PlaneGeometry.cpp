@@ -2,6 +2,7 @@
 
 #include "PlaneGeometry.h"
 #include "Random.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 #include "SurfacePoint.h"
 
@@ -17,32 +18,29 @@ float PlaneGeometry::getArea() const {
 	return std::numeric_limits<float>::infinity();
 }
 
-bool PlaneGeometry::calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const {
+bool PlaneGeometry::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
 	Vec3Df p = this->normal * this->distance;
 
-	float dir_dot_normal = Vec3Df::dotProduct(dir, this->normal);
+	float dir_dot_normal = Vec3Df::dotProduct(ray.direction, this->normal);
 
 	if (dir_dot_normal == 0.0f) {
 		return false;
 	}
-	else if (dir_dot_normal > 0.0f) {
-		intersection.isInside = true;
-	}
-	else {
-		intersection.isInside = false;
-	}
 
-	float t = Vec3Df::dotProduct(p - origin, this->normal) / dir_dot_normal;
+	float t = Vec3Df::dotProduct(p - ray.origin, this->normal) / dir_dot_normal;
 
-	if (t < 0.0f) {
+	if (t < 0.0f || t < ray.minDistance || t > ray.maxDistance) {
 		return false;
 	}
 
-	intersection.geometry = this->shared_from_this();
+	intersection.geometry = this;
+	intersection.isInside = dir_dot_normal > 0.0f;
 	intersection.distance = t;
-	intersection.direction = dir;
-	intersection.origin = origin;
-	intersection.hitPoint = origin + t * dir;
+	intersection.direction = ray.direction;
+	intersection.origin = ray.origin;
+	intersection.hitPoint = ray.getPoint(t);
+
+	ray.maxDistance = t;
 
 	return true;
 }
@@ -76,7 +74,7 @@ void PlaneGeometry::getRandomSurfacePoint(SurfacePoint &surface) const {
 	// Offset the point with the two orthogonal vectors scaled by the random numbers
 	point += x * v + y * v;
 
-	surface.geometry = this->shared_from_this();
+	surface.geometry = this;
 	surface.normal = this->normal;
 	surface.point = point;
 	surface.texCoords = Vec2Df(x, y);
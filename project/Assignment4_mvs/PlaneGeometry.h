@@ -28,12 +28,11 @@ public:
 	/*
 	* Calculates whether the object is hit by the given ray and sets the intersection parameter
 	* to the RayIntersection representing the closest point of intersection.
-	* @param[in] origin The origin of the ray.
-	* @param[in] dir The direction of the ray.
+	* @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
 	* @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
 	* @return True if the ray intersected an object; otherwise false.
 	*/
-	virtual bool calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const;
+	virtual bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const;
 
 	/**
 	 * Gets the surface point on this geometry at the given intersection point.
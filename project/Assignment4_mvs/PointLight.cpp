@@ -22,6 +22,14 @@ void PointLight::setColor(const Vec3Df &color) {
 	this->color = color;
 }
 
+BoundingBox PointLight::getBoundingBox() const {
+	return BoundingBox(this->position, this->position);
+}
+
+float PointLight::getPower() const {
+	return this->getIntensity() * (this->color[0] + this->color[1] + this->color[2]) / 3.0f;
+}
+
 bool PointLight::sampleLight(const Vec3Df &point, Vec3Df &lightPoint, Vec3Df &lightColor) const {
 	// Set the light point to the position of the light
 	lightPoint = this->position;
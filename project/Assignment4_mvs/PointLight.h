@@ -51,6 +51,18 @@ public:
 	*/
 	void setPosition(const Vec3Df &position);
 
+	/**
+	 * Gets the bounding box of the light, which only contains its position.
+	 * @return The bounding box of the light.
+	 */
+	BoundingBox getBoundingBox() const;
+
+	/**
+	 * Gets an estimate of the total amount of light emitted by the light.
+	 * @return The intensity of the light multiplied by the average of its color.
+	 */
+	float getPower() const;
+
 	/**
 	 * Calculates the direction from a point on the light source towards the given point
 	 * and the light emitted along this direction.
@@ -0,0 +1,124 @@
+#include <cassert>
+#include <omp.h>
+
+#include "ICamera.h"
+#include "Image.h"
+#include "ISampler.h"
+#include "ProgressiveRenderer.h"
+#include "Random.h"
+#include "RGBValue.h"
+#include "Scene.h"
+#include "TileScheduler.h"
+
+ProgressiveRenderer::ProgressiveRenderer(std::shared_ptr<Scene> scene, std::shared_ptr<ICamera> camera, int width, int height)
+: width(width),
+height(height),
+passCount(0),
+snapshotInterval(0),
+scene(scene),
+camera(camera) {
+	assert(scene);
+	assert(camera);
+	assert(width > 0);
+	assert(height > 0);
+
+	this->reset();
+}
+
+int ProgressiveRenderer::getPassCount() const {
+	return this->passCount;
+}
+
+int ProgressiveRenderer::getSnapshotInterval() const {
+	return this->snapshotInterval;
+}
+
+void ProgressiveRenderer::setSnapshotCallback(SnapshotCallback callback, int interval) {
+	assert(interval >= 0);
+
+	this->snapshotCallback = callback;
+	this->snapshotInterval = callback ? interval : 0;
+}
+
+int ProgressiveRenderer::render(int maxPasses, double timeBudget) {
+	assert(maxPasses >= 0);
+	assert(timeBudget >= 0.0);
+
+	double start = omp_get_wtime();
+	int passes = 0;
+
+	while (passes < maxPasses && omp_get_wtime() - start < timeBudget) {
+		this->renderPass();
+
+		passes++;
+		this->passCount++;
+
+		// Publish a snapshot every few passes
+		if (this->snapshotInterval > 0 && this->passCount % this->snapshotInterval == 0) {
+			this->snapshotCallback(this->getSnapshot(), this->passCount);
+		}
+	}
+
+	return passes;
+}
+
+std::shared_ptr<Image> ProgressiveRenderer::getSnapshot() const {
+	auto result = std::make_shared<Image>(this->width, this->height);
+
+	if (this->passCount == 0)
+		return result;
+
+	float scale = 1.0f / this->passCount;
+
+	for (int y = 0; y < this->height; y++) {
+		for (int x = 0; x < this->width; x++) {
+			Vec3Df color = this->accumulation[y * this->width + x] * scale;
+
+			result->setPixel(x, y, RGBValue(color[0], color[1], color[2]));
+		}
+	}
+
+	return result;
+}
+
+void ProgressiveRenderer::reset() {
+	this->scene->preprocess();
+	this->camera->preprocess(this->width, this->height);
+
+	this->passCount = 0;
+	this->accumulation.assign(this->width * this->height, Vec3Df());
+}
+
+void ProgressiveRenderer::renderPass() {
+	TileScheduler scheduler(this->width, this->height, TileScheduler::DefaultTileSize, omp_get_max_threads());
+	const Scene *scene = this->scene.get();
+	const ICamera *camera = this->camera.get();
+	const ISampler *sampler = scene->getSampler().get();
+	Vec3Df *accumulation = &this->accumulation[0];
+	int width = this->width;
+
+#pragma omp parallel shared(scheduler)
+	{
+		int thread = omp_get_thread_num();
+		int pass = this->passCount;
+		Tile tile;
+
+		// Every pixel belongs to exactly one tile, so threads never add to the same pixel
+		while (scheduler.getNextTile(thread, tile)) {
+			for (int y = tile.y; y < tile.y + tile.height; y++) {
+				for (int x = tile.x; x < tile.x + tile.width; x++) {
+					// Jitter the sample within the pixel, so the average over all passes is antialiased.
+					// Each pass is the next sample of every pixel.
+					Random::startSample(sampler, x, y, pass);
+
+					float u = Random::randUnit();
+					float v = Random::randUnit();
+
+					accumulation[y * width + x] += scene->renderSample(camera, x, y, u, v);
+				}
+			}
+
+			scheduler.completeTile();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef PROGRESSIVERENDERER_H
+#define PROGRESSIVERENDERER_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Vec3D.h"
+
+class ICamera;
+class Image;
+class Scene;
+
+/**
+ * Renders a scene progressively, one sample per pixel per pass.
+ *
+ * The samples of all passes are summed in an accumulation buffer which persists between calls to render,
+ * so rendering can be stopped after any number of passes or when a time budget runs out and resumed later.
+ * Snapshots of the average of the passes so far can be taken at any time.
+ */
+class ProgressiveRenderer {
+public:
+	/**
+	 * Function called with a snapshot of the image and the number of passes it contains.
+	 */
+	typedef std::function<void(std::shared_ptr<const Image>, int)> SnapshotCallback;
+
+	/**
+	 * Initializes a ProgressiveRenderer and preprocesses the scene and the camera.
+	 * @param[in] scene Pointer to the scene to be rendered.
+	 * @param[in] camera Pointer to the camera that observes the scene.
+	 * @param width The width of the render.
+	 * @param height The height of the render.
+	 */
+	ProgressiveRenderer(std::shared_ptr<Scene> scene, std::shared_ptr<ICamera> camera, int width, int height);
+
+	/**
+	 * Gets the number of passes accumulated so far.
+	 * @return The number of passes accumulated so far.
+	 */
+	int getPassCount() const;
+
+	/**
+	 * Gets the number of passes between two snapshots passed to the snapshot callback.
+	 * @return The number of passes between two snapshots, or zero if no snapshots are published.
+	 */
+	int getSnapshotInterval() const;
+
+	/**
+	 * Sets the function which is called with a snapshot of the image every few passes.
+	 * @param[in] callback The function called with each snapshot.
+	 * @param interval The number of passes between two snapshots, or zero to not publish any snapshots.
+	 */
+	void setSnapshotCallback(SnapshotCallback callback, int interval);
+
+	/**
+	 * Renders passes until the given number of passes has been rendered or the time budget has run out.
+	 * A pass that has been started is always completed, so the budget may be exceeded by at most one pass.
+	 * @param maxPasses The maximum number of passes to be rendered.
+	 * @param timeBudget The time in seconds after which no new pass is started.
+	 * @return The number of passes rendered.
+	 */
+	int render(int maxPasses, double timeBudget);
+
+	/**
+	 * Creates an image containing the average of the passes rendered so far.
+	 * @return Pointer to an image containing the rendered scene.
+	 */
+	std::shared_ptr<Image> getSnapshot() const;
+
+	/**
+	 * Discards all passes and preprocesses the scene and the camera again, which is needed after either has changed.
+	 */
+	void reset();
+
+private:
+	/**
+	 * Renders a single sample for each pixel and adds it to the accumulation buffer.
+	 */
+	void renderPass();
+
+	int width;
+	int height;
+	int passCount;
+	int snapshotInterval;
+	SnapshotCallback snapshotCallback;
+	std::shared_ptr<Scene> scene;
+	std::shared_ptr<ICamera> camera;
+	std::vector<Vec3Df> accumulation;
+};
+
+#endif
\ No newline at end of file
@@ -1,62 +1,66 @@
-#define _CRT_RAND_S
-
-#include <cstdlib>
+#include <algorithm>
 #include <cmath>
-#include <ctime>
 
 #include "Constants.h"
+#include "ISampler.h"
 #include "Random.h"
+#include "SobolSampler.h"
 
-#ifndef WIN32
-__thread bool Random::initialized;
-__thread unsigned int Random::seed;
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
 #endif
 
-unsigned int Random::rand() {
-#if !defined(_OPENMP) || !defined(__GLIBC__)
-	return ::rand();
-#else
- #ifdef WIN32
-	// rand_s is threadsafe and generates an unsigned integer in the range [0, UINT_MAX]
-	unsigned int rnd;
-	rand_s(&rnd);
-
-	// Return a random number
-	return rnd % RAND_MAX;
- #else
-	if (!Random::initialized) {
-		Random::initialized = true;
-		Random::seed = time(NULL);
-	}
+// The sequence of the sample the calling thread is working on. These are plain values
+// which start at zero, so the generator never needs to check whether they were initialized.
+static THREAD_LOCAL const ISampler *currentSampler;
+static THREAD_LOCAL int currentX;
+static THREAD_LOCAL int currentY;
+static THREAD_LOCAL unsigned int currentKey;
+static THREAD_LOCAL unsigned int currentSampleIndex;
+static THREAD_LOCAL unsigned int currentDimension;
+
+void Random::startSample(const ISampler *sampler, int x, int y, unsigned int sampleIndex) {
+	currentSampler = sampler;
+	currentX = x;
+	currentY = y;
+	currentKey = Random::getPixelKey(x, y);
+	currentSampleIndex = sampleIndex;
+	currentDimension = 0;
+}
 
-	// Return a random number
-	return rand_r(&seed);
- #endif
-#endif
+unsigned int Random::getPixelKey(int x, int y) {
+	return (unsigned int)y << 16 | ((unsigned int)x & 0xFFFF);
 }
 
-float Random::randUnit() {
-#if !defined(_OPENMP) || !defined(__GLIBC__)
-	// Return a random float in the range [0, 1]
-	return ::rand() / static_cast<float>(RAND_MAX);
-#else
-#ifdef WIN32
-	// rand_s is threadsafe and generates an unsigned integer in the range [0, UINT_MAX]
-	unsigned int rnd;
-	rand_s(&rnd);
-
-	// Return a random float in the range [0, 1]
-	return rnd / static_cast<float>(UINT_MAX);
- #else
-	if (!Random::initialized) {
-		Random::initialized = true;
-		Random::seed = time(NULL);
+unsigned int Random::generate(unsigned int key, unsigned int sampleIndex, unsigned int dimension) {
+	// The counter is the pair of sample index and dimension, each round multiplies one half and
+	// mixes the result with the other half and the key, which is bumped by the golden ratio every round
+	unsigned int left = sampleIndex;
+	unsigned int right = dimension;
+
+	for (int i = 0; i < 10; i++) {
+		unsigned long long product = 0xD256D193ULL * right;
+
+		right = (unsigned int)(product >> 32) ^ key ^ left;
+		left = (unsigned int)product;
+		key += 0x9E3779B9;
 	}
 
-	// Return a random float in the range [0, 1]
-	return rand_r(&seed) / static_cast<float>(RAND_MAX);
- #endif
-#endif
+	return right;
+}
+
+unsigned int Random::rand() {
+	if (currentSampler)
+		return currentSampler->getSample(currentX, currentY, currentSampleIndex, currentDimension++);
+
+	return Random::generate(currentKey, currentSampleIndex, currentDimension++);
+}
+
+float Random::randUnit() {
+	// Use the upper 24 bits, which a float represents exactly, to return a random float in the range [0, 1)
+	return (Random::rand() >> 8) * (1.0f / 16777216.0f);
 }
 
 void Random::sampleUnitDisk(float &u, float &v) {
@@ -80,6 +84,40 @@ void Random::sampleUnitSquare(float &u, float &v) {
 	v = Random::randUnit();
 }
 
+void Random::sampleStratifiedSquare(unsigned int index, unsigned int seed, float &u, float &v) {
+	// The first two dimensions of the Sobol sequence stratify every power of two of its points,
+	// which an Owen scramble keeps intact while making every point uniformly distributed
+	u = (SobolSampler::scramble(SobolSampler::getSobol(index, 0), Random::generate(seed, 0, 0)) >> 8) * (1.0f / 16777216.0f);
+	v = (SobolSampler::scramble(SobolSampler::getSobol(index, 1), Random::generate(seed, 1, 0)) >> 8) * (1.0f / 16777216.0f);
+}
+
+void Random::mapUnitDisk(float u, float v, float &x, float &y) {
+	// Map the point to [-1, 1] x [-1, 1]
+	float a = 2.0f * u - 1.0f;
+	float b = 2.0f * v - 1.0f;
+
+	if (a == 0.0f && b == 0.0f) {
+		x = 0.0f;
+		y = 0.0f;
+		return;
+	}
+
+	// Map concentric squares to concentric circles, measuring the angle within the wedge of the larger component
+	float r, phi;
+
+	if (fabsf(a) > fabsf(b)) {
+		r = a;
+		phi = Constants::PiOver4 * (b / a);
+	}
+	else {
+		r = b;
+		phi = Constants::PiOver4 * (2.0f - a / b);
+	}
+
+	x = r * cosf(phi);
+	y = r * sinf(phi);
+}
+
 Vec3Df Random::sampleUnitSphere() {
 	float phi;
 	float cosTheta;
@@ -109,3 +147,20 @@ Vec3Df Random::sampleHemisphere(const Vec3Df &normal) {
 
 	return point;
 }
+
+
+Vec3Df Random::sampleCosineHemisphere(const Vec3Df &normal) {
+	// Get two unit vectors orthogonal to the normal
+	Vec3Df u, v;
+	normal.getTwoOrthogonals(u, v);
+	u.normalize();
+	v.normalize();
+
+	// Project a uniformly distributed point on the unit disk up onto the hemisphere (Malley's method)
+	float phi = Random::randUnit() * Constants::TwoPi;
+	float sinTheta2 = Random::randUnit();
+	float sinTheta = sqrtf(sinTheta2);
+	float cosTheta = sqrtf(std::max(0.0f, 1.0f - sinTheta2));
+
+	return sinTheta * cosf(phi) * u + sinTheta * sinf(phi) * v + cosTheta * normal;
+}
\ No newline at end of file
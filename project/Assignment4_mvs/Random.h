@@ -3,20 +3,58 @@
 
 #include "Vec3D.h"
 
+class ISampler;
+
 /**
  * Provides useful randomization functions.
+ *
+ * Random numbers are generated by a counter-based generator (Philox-2x32-10), which hashes the pixel,
+ * the index of the sample within the pixel and the dimension, the index of the random number within the sample.
+ * The renderers start the sequence of each sample with startSample, after which each call draws the next dimension.
+ * A sampler may be given to startSample, in which case the numbers are taken from it instead,
+ * so every use of randomness draws from the same well distributed sequence.
+ * As every random number only depends on where it is used, renders are identical for any number of threads
+ * and any order of the tiles, and any part of an image can be rendered on its own.
  */
 class Random {
 public:
+	/**
+	 * Starts the sequence of random numbers for a sample of the given pixel on the calling thread.
+	 * @param sampler The sampler generating the sequence, or nullptr to use the counter-based generator.
+	 * The sampler must remain valid until the next sample is started.
+	 * @param x The x-coordinate of the pixel, in the range [0, 65535].
+	 * @param y The y-coordinate of the pixel, in the range [0, 65535].
+	 * @param sampleIndex The index of the sample within the pixel.
+	 */
+	static void startSample(const ISampler *sampler, int x, int y, unsigned int sampleIndex);
+
+	/**
+	 * Gets the key identifying the given pixel.
+	 * @param x The x-coordinate of the pixel, in the range [0, 65535].
+	 * @param y The y-coordinate of the pixel, in the range [0, 65535].
+	 * @return The key identifying the pixel.
+	 */
+	static unsigned int getPixelKey(int x, int y);
+
+	/**
+	 * Generates the random number of the given dimension of a sample.
+	 * This does not depend on or change the sequence of the calling thread.
+	 * @param key The key identifying the pixel.
+	 * @param sampleIndex The index of the sample within the pixel.
+	 * @param dimension The index of the random number within the sample.
+	 * @return A random unsigned integer in the range [0, UINT_MAX].
+	 */
+	static unsigned int generate(unsigned int key, unsigned int sampleIndex, unsigned int dimension);
+
 	/** 
-	 * Returns a random unsigned integer in the range [0, RAND_MAX].
-	 * @return A random unsigned integer in the range [0, RAND_MAX].
+	 * Returns the next random unsigned integer of the current sample.
+	 * @return A random unsigned integer in the range [0, UINT_MAX].
 	 */
 	static unsigned int rand();
 
 	/**
-	 * Returns a random float in the range [0, 1].
-	 * @return A random float in the range [0, 1].
+	 * Returns the next random float of the current sample.
+	 * @return A random float in the range [0, 1).
 	 */
 	static float randUnit();
 
@@ -30,12 +68,34 @@ public:
 
 	/**
 	 * Returns two floating point numbers in the unit square.
-	 * The range is [-1, 1] x [-1, 1].
+	 * The range is [0, 1) x [0, 1).
 	 * @param[out] u The u component.
 	 * @param[out] v The v component.
 	 */
 	static void sampleUnitSquare(float &u, float &v);
 
+	/**
+	 * Returns a point of a randomly scrambled set of stratified points in the unit square.
+	 * Every point is uniformly distributed on its own, while the first n points of a set
+	 * cover the square much more evenly than n independent points.
+	 * The range is [0, 1) x [0, 1).
+	 * @param index The index of the point within the set.
+	 * @param seed The seed selecting the set, for instance a random number drawn once for all of its points.
+	 * @param[out] u The u component.
+	 * @param[out] v The v component.
+	 */
+	static void sampleStratifiedSquare(unsigned int index, unsigned int seed, float &u, float &v);
+
+	/**
+	 * Maps a point in the unit square to the unit disk with the concentric mapping of Shirley and Chiu,
+	 * which preserves the uniformity and the stratification of the points.
+	 * @param u The u component of the point in the unit square.
+	 * @param v The v component of the point in the unit square.
+	 * @param[out] x The x component of the point in the unit disk.
+	 * @param[out] y The y component of the point in the unit disk.
+	 */
+	static void mapUnitDisk(float u, float v, float &x, float &y);
+
 	/**
 	 * Returns a random point on the unit sphere.
 	 * The range is [-1, 1] x [-1, 1] x [-1, 1], x^2 + y^2 + z^2 = 1.
@@ -51,11 +111,13 @@ public:
 	 */
 	static Vec3Df sampleHemisphere(const Vec3Df &normal);
 
-#ifndef WIN32
-private:
-	static __thread bool initialized;
-	static __thread unsigned int seed;
-#endif
+	/**
+	 * Returns a random point on the hemisphere defined by the given normal, where the density
+	 * of the points is proportional to the cosine of the angle with the normal.
+	 * @param[in] normal The normal defining the hemisphere to be sampled.
+	 * @return A point on the given hemisphere.
+	 */
+	static Vec3Df sampleCosineHemisphere(const Vec3Df &normal);
 };
 
 #endif
\ No newline at end of file
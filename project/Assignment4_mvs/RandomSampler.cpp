@@ -0,0 +1,6 @@
+#include "Random.h"
+#include "RandomSampler.h"
+
+unsigned int RandomSampler::getSample(int x, int y, unsigned int sampleIndex, unsigned int dimension) const {
+	return Random::generate(Random::getPixelKey(x, y), sampleIndex, dimension);
+}
\ No newline at end of file
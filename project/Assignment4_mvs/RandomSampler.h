@@ -0,0 +1,22 @@
+#ifndef RANDOMSAMPLER_H
+#define RANDOMSAMPLER_H
+
+#include "ISampler.h"
+
+/**
+ * Represents a sampler which generates independent uniformly distributed random numbers.
+ */
+class RandomSampler : public ISampler {
+public:
+	/**
+	 * Gets the given dimension of a sample of the given pixel.
+	 * @param x The x-coordinate of the pixel.
+	 * @param y The y-coordinate of the pixel.
+	 * @param sampleIndex The index of the sample within the pixel.
+	 * @param dimension The index of the random number within the sample.
+	 * @return An unsigned integer in the range [0, UINT_MAX], which maps to [0, 1) when divided by 2^32.
+	 */
+	unsigned int getSample(int x, int y, unsigned int sampleIndex, unsigned int dimension) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include <limits>
+
+#include "Ray.h"
+
+Ray::Ray(const Vec3Df &origin, const Vec3Df &direction)
+: Ray(origin, direction, 0.0f, std::numeric_limits<float>::infinity()) {
+}
+
+Ray::Ray(const Vec3Df &origin, const Vec3Df &direction, float minDistance, float maxDistance)
+: origin(origin), direction(direction), minDistance(minDistance), maxDistance(maxDistance) {
+	for (int i = 0; i < 3; i++) {
+		// A zero component yields an infinite reciprocal, which the slab test handles.
+		// The sign is taken from the reciprocal so that -0 is treated as negative.
+		this->invDirection[i] = 1.0f / direction[i];
+		this->sign[i] = this->invDirection[i] < 0.0f ? 1 : 0;
+	}
+}
+
+Vec3Df Ray::getPoint(float distance) const {
+	return this->origin + distance * this->direction;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef RAY_H
+#define RAY_H
+
+#include "Vec3D.h"
+
+/**
+ * Represents a ray together with the interval [minDistance, maxDistance] in which intersections are accepted.
+ *
+ * The reciprocal of the direction and the sign of each of its components are computed once,
+ * so testing the ray against a bounding box only requires multiplications.
+ * When looking for the closest intersection maxDistance shrinks to the distance of the closest intersection
+ * found so far, so anything further away is rejected early.
+ *
+ * The equation for the ray is as follows:
+ * R(t) = origin + t * direction
+ */
+class Ray {
+public:
+	/**
+	 * Initializes a Ray with the given origin and direction which accepts all intersections in front of its origin.
+	 * @param[in] origin The origin of the ray.
+	 * @param[in] direction The direction of the ray.
+	 */
+	Ray(const Vec3Df &origin, const Vec3Df &direction);
+
+	/**
+	 * Initializes a Ray with the given origin and direction which accepts intersections in the given interval.
+	 * @param[in] origin The origin of the ray.
+	 * @param[in] direction The direction of the ray.
+	 * @param minDistance The minimum distance at which an intersection may occur.
+	 * @param maxDistance The maximum distance at which an intersection may occur.
+	 */
+	Ray(const Vec3Df &origin, const Vec3Df &direction, float minDistance, float maxDistance);
+
+	/**
+	 * Gets the point at the given distance along the ray.
+	 * @param distance The distance along the ray.
+	 * @return The point at the given distance along the ray.
+	 */
+	Vec3Df getPoint(float distance) const;
+
+	/**
+	 * The origin of the ray.
+	 */
+	Vec3Df origin;
+
+	/**
+	 * The direction of the ray.
+	 */
+	Vec3Df direction;
+
+	/**
+	 * The component-wise reciprocal of the direction.
+	 */
+	Vec3Df invDirection;
+
+	/**
+	 * For each axis 1 if the direction is negative along it; otherwise 0.
+	 */
+	int sign[3];
+
+	/**
+	 * The minimum distance at which an intersection may occur.
+	 */
+	float minDistance;
+
+	/**
+	 * The maximum distance at which an intersection may occur.
+	 */
+	float maxDistance;
+};
+
+#endif
\ No newline at end of file
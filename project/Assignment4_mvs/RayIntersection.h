@@ -1,8 +1,7 @@
 #ifndef RAYINTERSECTION_H
 #define RAYINTERSECTION_H
 
-#include <memory>
-
+#include "Vec2D.h"
 #include "Vec3D.h"
 
 class IGeometry;
@@ -59,8 +58,22 @@ public:
 
 	/**
 	 * The geometry that the ray intersects with.
+	 * This is a plain pointer so recording a hit does not touch any reference counts,
+	 * the geometry is owned by the scene.
+	 */
+	const IGeometry *geometry;
+
+	/**
+	 * The index of the primitive within the geometry that the ray intersects with,
+	 * for geometry that is composed of primitives such as a MeshGeometry.
+	 */
+	unsigned int primitiveIndex;
+
+	/**
+	 * The barycentric coordinates of the intersection within the primitive,
+	 * the weights of its second and third vertex.
 	 */
-	std::shared_ptr<const IGeometry> geometry;
+	Vec2Df barycentricCoordinates;
 };
 
 
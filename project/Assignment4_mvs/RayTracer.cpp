@@ -1,9 +1,7 @@
-#include <algorithm>
 #include <cassert>
 #include <vector>
 
 #include "Constants.h"
-#include "ILight.h"
 #include "Random.h"
 #include "RayTracer.h"
 #include "RayIntersection.h"
@@ -66,16 +64,10 @@ Vec3Df RayTracer::performShading(const RayIntersection &intersection, int iterat
 	// Get a pointer to the scene.
 	const Scene *scene = this->getScene();
 
-	// Needed for the shadow intersection test but can be ignored.
-	RayIntersection shadowIntersection;
-
 	// Get the surface point at the intersection point, this contains surface parameters useful for shading.
 	SurfacePoint surface;
 	intersection.getSurfacePoint(surface);
 
-	// Get the vector contain the scene's lights.
-	std::shared_ptr<const std::vector<std::shared_ptr<ILight>>> lights = scene->getLights();
-
 	// The 'view' vector is the opposite of the ray direction
 	Vec3Df viewVector = -intersection.direction;
 
@@ -84,7 +76,14 @@ Vec3Df RayTracer::performShading(const RayIntersection &intersection, int iterat
 	lighting += surface.emittedLight(viewVector);
 
 	// Perform path tracing only if it's enabled and the object hit is not a light source
-	if (scene->getPathTracingEnabled() && lighting[0] == 0.0f && lighting[1] == 0.0f && lighting[2] == 0.0f) {
+	bool isPathTraced = scene->getPathTracingEnabled() && lighting[0] == 0.0f && lighting[1] == 0.0f && lighting[2] == 0.0f;
+
+	// Diffuse surfaces seen from the camera may take the indirect light from the irradiance cache instead.
+	// The reflected direction is sampled uniformly over the hemisphere, so the expected reflected light is the irradiance over 2 pi.
+	if (isPathTraced && iteration == 0 && scene->getIrradianceCacheEnabled() && surface.isDiffuse()) {
+		lighting += surface.diffuseLight(viewVector, this->calculateIrradiance(surface, iteration)) / Constants::TwoPi;
+	}
+	else if (isPathTraced) {
 		float distance;
 
 		// Sample a random direction in the hemisphere defined by the surface normal
@@ -107,52 +106,13 @@ Vec3Df RayTracer::performShading(const RayIntersection &intersection, int iterat
 	lighting += surface.specularLight(viewVector, scene, iteration);
 	lighting += surface.transmittedLight(viewVector, scene, iteration);
 
-	// Iterate through all lights and sum the reflected light
-	for (std::vector<std::shared_ptr<ILight>>::const_iterator it = lights->begin(); it != lights->end(); ++it) {
-		// Get the light color and the light vector
-		std::shared_ptr<ILight> light = (*it);
-		Vec3Df lightPoint;
-		Vec3Df lightColor;
-		Vec3Df lightVector;
-		Vec3Df lightContribution = Vec3Df();
-
-		// Calculate the number of light sampels to be taken based of the light's area
-		int lightSamples = (int)std::max(1.0f, light->getArea() * scene->getLightSampleDensity());
-
-		// If the light is associated with the geometry we are trying to 
-		if (light->getGeometry() == intersection.geometry)
-			continue;
-
-		for (int i = 0; i < lightSamples; i++) {
-			// Sample the light for a position and color
-			if (!light->sampleLight(surface.point, lightPoint, lightColor))
-				continue;
-
-			// Compute the vector from the intersection towards the light
-			lightVector = (lightPoint - surface.point);
-			float lightDistance = lightVector.normalize();
-
-			// The length of the shadow ray segment, this is sligthly smaller
-			// than the actual distance between the object and light to
-			// prevent intersecting the object and lightsource themselves.
-			float segmentLength = lightDistance - 2.0f * Constants::Epsilon;
-
-			// If the light and object are extremely close then the segment length may become negative,
-			// only check shadows if there is enough room between the object and light.
-			if (segmentLength > 0.0f) {
-				// If the segment between the light and intersection intersects any geometry
-				// then the intersection is in shadow, continue to the next light.
-				if (scene->calculateAnyIntersection(surface.point + lightVector * Constants::Epsilon, lightVector, segmentLength, shadowIntersection))
-					continue;
-			}
-
-			// Evaluate the BRDF, essentially
-			lightContribution += surface.reflectedLight(lightVector, viewVector, lightColor);
-		}
-
-		lighting += lightContribution / (float)lightSamples;
-	}
+	// Add the light reflected directly from the light sources
+	lighting += this->calculateDirectLight(intersection, surface);
 
 	// Return the accumulated lighting
 	return lighting;
+}
+
+Vec3Df RayTracer::traceIndirectRay(const Vec3Df &origin, const Vec3Df &dir, int iteration, float &distance) const {
+	return this->performRayTracingIteration(origin, dir, iteration + 1, distance);
 }
\ No newline at end of file
@@ -27,6 +27,18 @@ public:
 		int iteration,
 		float &distance) const;
 
+protected:
+	/**
+	 * Traces an indirect ray from a surface whose irradiance is being calculated as the next iteration.
+	 *
+	 * @param[in] origin	The origin of the ray.
+	 * @param[in] dir		The direction of the ray.
+	 * @param[in] iteration	The iteration of the surface the ray leaves.
+	 * @param[out] distance	The distance to the closest surface hit by the ray.
+	 * @return The light towards the given ray.
+	 */
+	Vec3Df traceIndirectRay(const Vec3Df &origin, const Vec3Df &dir, int iteration, float &distance) const;
+
 private:
 	/**
 	 * Calculates the light reflected towards the ray from the point of intersection.
@@ -1,49 +1,94 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdlib>
-#include <ctime>
+#include <limits>
 #include <omp.h>
 
 #include "BTreeAccelerator.h"
+#include "BVHAccelerator.h"
 #include "Image.h"
 #include "IAccelerationStructure.h"
 #include "ICamera.h"
 #include "IGeometry.h"
 #include "ILight.h"
+#include "IrradianceCache.h"
 #include "IRayTracer.h"
-#include "NoAccelerationStructure.h"
+#include "LightTree.h"
+#include "ISampler.h"
+#include "PixelEstimator.h"
 #include "Random.h"
+#include "Ray.h"
 #include "RayIntersection.h"
+#include "RandomSampler.h"
 #include "RayTracer.h"
+#include "RGBValue.h"
 #include "Scene.h"
+#include "TileScheduler.h"
 #include "Vec3D.h"
 
+/**
+ * Prints the progress of a render whenever another percent of the tiles has been completed.
+ */
+static void reportProgress(int completedTiles, int tileCount, int &reportedPercentage) {
+	int percentage = 100 * completedTiles / tileCount;
+
+	if (percentage > reportedPercentage) {
+		std::cout << "Tiles: " << completedTiles << " / " << tileCount << " (" << percentage << "%)" << std::endl;
+		reportedPercentage = percentage;
+	}
+}
+
 Scene::Scene() :
-geometry(std::make_shared<std::vector<std::shared_ptr<IGeometry>>>()),
-lights(std::make_shared<std::vector<std::shared_ptr<ILight>>>()),
-lightSampleDensity(1.0f),
-samplesPerPixel(1),
+pathTracingEnabled(false),
 ambientOcclusionSamples(0),
+ambientOcclusionRadius(std::numeric_limits<float>::infinity()),
+ambientOcclusionCacheEnabled(false),
+irradianceCacheEnabled(false),
+irradianceSamples(256),
+samplesPerPixel(1),
+noiseThreshold(0.0f),
 maxTraceDepth(4),
-pathTracingEnabled(false)
+sampledLightCount(0),
+shadowProbeCount(0),
+lightSampleDensity(1.0f),
+geometry(std::make_shared<std::vector<std::shared_ptr<IGeometry>>>()),
+lights(std::make_shared<std::vector<std::shared_ptr<ILight>>>()),
+lightTree(std::make_shared<LightTree>()),
+ambientOcclusionCache(std::make_shared<IrradianceCache>()),
+irradianceCache(std::make_shared<IrradianceCache>())
 {
-	// Set the acceleration structure
-	this->setAccelerationStructure(std::make_shared<NoAccelerationStructure>());
+	// Set the acceleration structure, meshes act as bottom-level structures within it
+	this->setAccelerationStructure(std::make_shared<BVHAccelerator>());
 
 	// Set the default ray tracer
 	this->setRayTracer(std::make_shared<RayTracer>());
+
+	// Set the default sampler
+	this->setSampler(std::make_shared<RandomSampler>());
 }
 
 Scene::~Scene() {
 }
 
 bool Scene::calculateClosestIntersection(const Vec3Df & origin, const Vec3Df & dir, RayIntersection &intersection) const {
-	// Delegate the intersection calculations to the acceleration structure
-	return this->accelerator->calculateClosestIntersection(origin, dir, intersection);
+	Ray ray(origin, dir);
+
+	return this->calculateClosestIntersection(ray, intersection);
 }
 
 bool Scene::calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const {
+	return this->calculateAnyIntersection(Ray(origin, dir, 0.0f, maxDistance), intersection);
+}
+
+bool Scene::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
 	// Delegate the intersection calculations to the acceleration structure
-	return this->accelerator->calculateAnyIntersection(origin, dir, maxDistance, intersection);
+	return this->accelerator->calculateClosestIntersection(ray, intersection);
+}
+
+bool Scene::calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const {
+	// Delegate the intersection calculations to the acceleration structure
+	return this->accelerator->calculateAnyIntersection(ray, intersection);
 }
 
 void Scene::addGeometry(std::shared_ptr<IGeometry> geometry) {
@@ -65,9 +110,13 @@ std::shared_ptr<const std::vector<std::shared_ptr<IGeometry>>>Scene::getGeometry
 	return this->geometry;
 }
 
-std::shared_ptr<const std::vector<std::shared_ptr<ILight>>> Scene::getLights() const {
-	// Return a pointer to the light vector
-	return this->lights;
+const std::vector<std::shared_ptr<ILight>> &Scene::getLights() const {
+	// Return a reference to the light vector
+	return *this->lights;
+}
+
+std::shared_ptr<const LightTree> Scene::getLightTree() const {
+	return this->lightTree;
 }
 
 std::shared_ptr<const IAccelerationStructure> Scene::getAccelerationStructure() const {
@@ -91,14 +140,50 @@ int Scene::getAmbientOcclusionSamples() const {
 	return this->ambientOcclusionSamples;
 }
 
+float Scene::getAmbientOcclusionRadius() const {
+	return this->ambientOcclusionRadius;
+}
+
+bool Scene::getAmbientOcclusionCacheEnabled() const {
+	return this->ambientOcclusionCacheEnabled;
+}
+
+std::shared_ptr<IrradianceCache> Scene::getAmbientOcclusionCache() const {
+	return this->ambientOcclusionCache;
+}
+
+bool Scene::getIrradianceCacheEnabled() const {
+	return this->irradianceCacheEnabled;
+}
+
+int Scene::getIrradianceSamples() const {
+	return this->irradianceSamples;
+}
+
+std::shared_ptr<IrradianceCache> Scene::getIrradianceCache() const {
+	return this->irradianceCache;
+}
+
 int Scene::getSamplesPerPixel() const {
 	return this->samplesPerPixel;
 }
 
+float Scene::getNoiseThreshold() const {
+	return this->noiseThreshold;
+}
+
 int Scene::getMaxTraceDepth() const {
 	return this->maxTraceDepth;
 }
 
+int Scene::getSampledLightCount() const {
+	return this->sampledLightCount;
+}
+
+int Scene::getShadowProbeCount() const {
+	return this->shadowProbeCount;
+}
+
 void Scene::setAccelerationStructure(std::shared_ptr<IAccelerationStructure> accelerator) {
 	assert(accelerator);
 	
@@ -123,6 +208,16 @@ void Scene::setRayTracer(std::shared_ptr<IRayTracer> rayTracer) {
 	this->rayTracer->setScene(this);
 }
 
+std::shared_ptr<const ISampler> Scene::getSampler() const {
+	return this->sampler;
+}
+
+void Scene::setSampler(std::shared_ptr<ISampler> sampler) {
+	assert(sampler);
+
+	this->sampler = sampler;
+}
+
 void Scene::setLightSampleDensity(float density) {
 	assert(density >= 0.0f);
 
@@ -143,18 +238,56 @@ void Scene::setAmbientOcclusionSamples(int numSamples) {
 	this->ambientOcclusionSamples = numSamples;
 }
 
+void Scene::setAmbientOcclusionRadius(float radius) {
+	assert(radius > 0.0f);
+
+	this->ambientOcclusionRadius = radius;
+}
+
+void Scene::setAmbientOcclusionCacheEnabled(bool enabled) {
+	this->ambientOcclusionCacheEnabled = enabled;
+}
+
+void Scene::setIrradianceCacheEnabled(bool enabled) {
+	this->irradianceCacheEnabled = enabled;
+}
+
+void Scene::setIrradianceSamples(int numSamples) {
+	assert(numSamples >= 1);
+
+	this->irradianceSamples = numSamples;
+}
+
 void Scene::setSamplesPerPixel(int numSamples) {
 	assert(numSamples >= 1);
 
 	this->samplesPerPixel = numSamples;
 }
 
+void Scene::setNoiseThreshold(float threshold) {
+	assert(threshold >= 0.0f);
+
+	this->noiseThreshold = threshold;
+}
+
 void Scene::setMaxTraceDepth(int maxDepth) {
 	assert(maxDepth >= 1);
 
 	this->maxTraceDepth = maxDepth;
 }
 
+void Scene::setSampledLightCount(int count) {
+	assert(count >= 0);
+
+	this->sampledLightCount = count;
+}
+
+void Scene::setShadowProbeCount(int count) {
+	assert(count >= 0);
+
+	this->shadowProbeCount = count;
+}
+
 std::shared_ptr<Image> Scene::render(std::shared_ptr<ICamera> camera, int width, int height) {
 	assert(camera);
 	assert(width > 0);
@@ -169,50 +302,191 @@ std::shared_ptr<Image> Scene::render(std::shared_ptr<ICamera> camera, int width,
 	// Create an image
 	auto result = std::make_shared<Image>(width, height);
 
-	// A counter for the iteration of the ray-tracing algorithm. 
-	int iterationCounter = 0;
+	double start = omp_get_wtime();
+
+	std::cout << "Beginning rendering (" << height << "x" << width << ")" << std::endl;
 
+	// Adaptive sampling needs at least two samples per pixel to estimate the variance,
+	// with a single sample per pixel every pixel gets its sample uniformly
+	if (this->noiseThreshold > 0.0f && this->samplesPerPixel > 1)
+		this->renderAdaptive(camera.get(), *result);
+	else
+		this->renderUniform(camera.get(), *result);
 
-	clock_t start = clock();
+	std::cout << "Time: " << (omp_get_wtime() - start) << std::endl;
 
-	std::cout << "Beginning rendering (" << height << "x" << width << ")" << std::endl;
+	std::cout << "Done!" << std::endl;
+
+	return result;
+}
+
+void Scene::renderUniform(const ICamera *camera, Image &image) {
+	// Divide the image into tiles, every thread starts with its own part of the image
+	TileScheduler scheduler(image._width, image._height, TileScheduler::DefaultTileSize, omp_get_max_threads());
+	int tileCount = scheduler.getTileCount();
+	int reportedPercentage = 0;
 
-#pragma omp parallel shared(camera, result)
+#pragma omp parallel shared(scheduler, image, reportedPercentage)
 	{
-		// Set the random seed for each thread
-		srand(time(NULL) ^ omp_get_thread_num());
-
-		// Iterate through each pixel, collapse the calculation into separate threads if not on windows (seems like MVC doesnt support collapse)
-#ifdef WIN32
-#pragma omp for reduction(+:iterationCounter) schedule(dynamic)
-#else
-#pragma omp for reduction(+:iterationCounter) collapse(2) schedule(dynamic)
-#endif
-		for (int y = 0; y < height; y++) {
-			for (int x = 0; x < width; x++) {
-				iterationCounter++;
-
-				// Render the pixel
-				Vec3Df color = this->renderPixel(camera, x, y);
-
-				// Set the resulting color in the image
-				result->setPixel(x, y, RGBValue(color[0], color[1], color[2]));
-
-				if (iterationCounter % width == 0) {
-					std::cout << "Pixel: " << iterationCounter << " / " << (width * height) << std::endl;
+		// Each thread renders a tile into its own buffer and copies it into the image when done,
+		// so threads never write to neighbouring pixels at the same time
+		std::vector<Vec3Df> buffer(TileScheduler::DefaultTileSize * TileScheduler::DefaultTileSize);
+		int thread = omp_get_thread_num();
+		Tile tile;
+
+		while (scheduler.getNextTile(thread, tile)) {
+			for (int y = 0; y < tile.height; y++) {
+				for (int x = 0; x < tile.width; x++) {
+					buffer[y * tile.width + x] = this->renderPixel(camera, tile.x + x, tile.y + y);
 				}
 			}
+
+			for (int y = 0; y < tile.height; y++) {
+				for (int x = 0; x < tile.width; x++) {
+					const Vec3Df &color = buffer[y * tile.width + x];
+
+					image.setPixel(tile.x + x, tile.y + y, RGBValue(color[0], color[1], color[2]));
+				}
+			}
+
+			int completedTiles = scheduler.completeTile();
+
+			// Whichever thread completes a tile reports the progress, so the last tile always reports 100%
+#pragma omp critical(progress)
+			reportProgress(completedTiles, tileCount, reportedPercentage);
 		}
 	}
+}
 
-	clock_t end = clock();
-	std::cout << "Time: " << (end - start) / (double)CLOCKS_PER_SEC;
+void Scene::renderAdaptive(const ICamera *camera, Image &image) {
+	int width = image._width;
+	int height = image._height;
 
-	std::cout << "Done!" << std::endl;
+	// On average every pixel gets as many samples as without adaptive sampling. Every pixel
+	// gets a few samples to estimate its variance and no pixel gets more than a few times the average.
+	int averageSamples = this->samplesPerPixel * this->samplesPerPixel;
+	int minSamples = std::min(std::max(2, averageSamples / 4), averageSamples);
+	int maxSamples = 4 * averageSamples;
 
-	return result;
+	std::vector<PixelEstimator> estimators(width * height);
+	std::vector<std::vector<Tile>> noisyTiles(omp_get_max_threads());
+
+	TileScheduler scheduler(width, height, TileScheduler::DefaultTileSize, omp_get_max_threads());
+	int tileCount = scheduler.getTileCount();
+	int reportedPercentage = 0;
+	long long savedSamples = 0;
+
+	// Sample each tile within its share of the budget, and remember the tiles
+	// which ran out of samples before all of their pixels converged
+#pragma omp parallel shared(scheduler, estimators, noisyTiles, reportedPercentage) reduction(+:savedSamples)
+	{
+		int thread = omp_get_thread_num();
+		Tile tile;
+
+		while (scheduler.getNextTile(thread, tile)) {
+			long long budget = (long long)averageSamples * tile.width * tile.height;
+
+			if (!this->sampleTile(camera, tile, estimators, width, minSamples, maxSamples, budget)) {
+				noisyTiles[thread].push_back(tile);
+			}
+
+			// Only a tile which converged within its budget leaves samples for the noisy tiles
+			if (budget > 0) {
+				savedSamples += budget;
+			}
+
+			int completedTiles = scheduler.completeTile();
+
+			// Whichever thread completes a tile reports the progress, so the last tile always reports 100%
+#pragma omp critical(progress)
+			reportProgress(completedTiles, tileCount, reportedPercentage);
+		}
+	}
+
+	std::vector<Tile> tiles;
+
+	for (unsigned int i = 0; i < noisyTiles.size(); i++) {
+		tiles.insert(tiles.end(), noisyTiles[i].begin(), noisyTiles[i].end());
+	}
+
+	// Divide the samples saved on converged tiles evenly among the noisy tiles
+	if (!tiles.empty() && savedSamples > 0) {
+		int noisyTileCount = tiles.size();
+		long long share = savedSamples / noisyTileCount;
+
+#pragma omp parallel for schedule(dynamic) shared(tiles, estimators)
+		for (int i = 0; i < noisyTileCount; i++) {
+			long long budget = share;
+
+			this->sampleTile(camera, tiles[i], estimators, width, minSamples, maxSamples, budget);
+		}
+	}
+
+	long long totalSamples = 0;
+
+	// Store the estimated colors in the image
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			const PixelEstimator &estimator = estimators[y * width + x];
+			const Vec3Df &color = estimator.getMean();
+
+			image.setPixel(x, y, RGBValue(color[0], color[1], color[2]));
+			totalSamples += estimator.getSampleCount();
+		}
+	}
+
+	std::cout << "Samples: " << totalSamples << " (" << totalSamples / (double)(width * height) << " per pixel, "
+		<< tiles.size() << " / " << tileCount << " noisy tiles)" << std::endl;
+}
+
+bool Scene::sampleTile(const ICamera *camera, const Tile &tile, std::vector<PixelEstimator> &estimators, int width, int minSamples, int maxSamples, long long &budget) const {
+	// Take the samples needed to estimate the variance of each pixel
+	for (int y = tile.y; y < tile.y + tile.height; y++) {
+		for (int x = tile.x; x < tile.x + tile.width; x++) {
+			PixelEstimator &estimator = estimators[y * width + x];
+
+			while (estimator.getSampleCount() < minSamples) {
+				Random::startSample(this->sampler.get(), x, y, estimator.getSampleCount());
+				estimator.addSample(this->renderSample(camera, x, y, Random::randUnit(), Random::randUnit()));
+				budget--;
+			}
+		}
+	}
+
+	std::vector<int> active;
+
+	// Give every pixel which has not converged yet one more sample at a time, as long as the budget allows it
+	while (true) {
+		active.clear();
+
+		for (int y = tile.y; y < tile.y + tile.height; y++) {
+			for (int x = tile.x; x < tile.x + tile.width; x++) {
+				const PixelEstimator &estimator = estimators[y * width + x];
+
+				if (estimator.getSampleCount() < maxSamples && !estimator.hasConverged(this->noiseThreshold)) {
+					active.push_back(y * width + x);
+				}
+			}
+		}
+
+		if (active.empty())
+			return true;
+
+		if (budget < (long long)active.size())
+			return false;
+
+		for (unsigned int i = 0; i < active.size(); i++) {
+			int x = active[i] % width;
+			int y = active[i] / width;
+
+			// The random numbers of a sample only depend on its pixel and index, not on the order of the tiles
+			Random::startSample(this->sampler.get(), x, y, estimators[active[i]].getSampleCount());
+			estimators[active[i]].addSample(this->renderSample(camera, x, y, Random::randUnit(), Random::randUnit()));
+		}
+
+		budget -= active.size();
+	}
 }
-		
 
 void Scene::preprocess() {
 	// Preprocess all geometry
@@ -225,11 +499,28 @@ void Scene::preprocess() {
 		(*it)->preprocess();
 	}
 
+	// Build the hierarchy over the lights
+	this->lightTree->build(*this->lights);
+
+	// Start with empty caches of ambient occlusion and irradiance, spanning the geometry of finite size
+	BoundingBox bounds;
+
+	for (std::vector<std::shared_ptr<IGeometry>>::iterator it = this->geometry->begin(); it != this->geometry->end(); ++it) {
+		BoundingBox box = (*it)->getBoundingBox();
+		Vec3Df extent = box.max - box.min;
+
+		if (!box.isEmpty() && std::isfinite(extent[0]) && std::isfinite(extent[1]) && std::isfinite(extent[2]))
+			bounds.includeBoundingBox(box);
+	}
+
+	this->ambientOcclusionCache->clear(bounds);
+	this->irradianceCache->clear(bounds);
+
 	// Preprocess the acceleration structure
 	this->accelerator->preprocess();
 }
 
-Vec3Df Scene::renderPixel(std::shared_ptr<ICamera> camera, int x, int y) {
+Vec3Df Scene::renderPixel(const ICamera *camera, int x, int y) {
 	Vec3Df result = Vec3Df();
 
 	int samples = this->samplesPerPixel;
@@ -238,17 +529,24 @@ Vec3Df Scene::renderPixel(std::shared_ptr<ICamera> camera, int x, int y) {
 	for (int i = 0; i < samples; i++){
 		for (int j = 0; j < samples; j++) {
 			float u, v;
+			Random::startSample(this->sampler.get(), x, y, i * samples + j);
 			Random::sampleUnitSquare(u, v);
-			Vec3Df origin;
-			Vec3Df dir;
-
-			// Get the ray from the camera through the current pixel
-			camera->getRay(x, y, (i + u) / (float)samples, (j + v) / (float)samples, origin, dir);
 
-			// Trace the ray through the scene
-			result += this->rayTracer->performRayTracing(origin, dir);
+			// Trace a ray from the camera through the current pixel
+			result += this->renderSample(camera, x, y, (i + u) / (float)samples, (j + v) / (float)samples);
 		}
 	}
 
 	return result / (float)(samples * samples);
 }
+
+Vec3Df Scene::renderSample(const ICamera *camera, int x, int y, float subPixelX, float subPixelY) const {
+	Vec3Df origin;
+	Vec3Df dir;
+
+	// Get the ray from the camera through the given point of the pixel
+	camera->getRay(x, y, subPixelX, subPixelY, origin, dir);
+
+	// Trace the ray through the scene
+	return this->rayTracer->performRayTracing(origin, dir);
+}
@@ -11,8 +11,14 @@ class IAccelerationStructure;
 class ICamera;
 class IGeometry;
 class ILight;
+class IrradianceCache;
 class IRayTracer;
+class ISampler;
+class LightTree;
+class PixelEstimator;
+class Ray;
 class RayIntersection;
+struct Tile;
 
 /**
 * Represents a scene of 3D objects which can be rendered to an image.
@@ -43,6 +49,25 @@ public:
 	*/
 	bool calculateAnyIntersection(const Vec3Df &origin, const Vec3Df &dir, float maxDistance, RayIntersection &intersection) const;
 
+	/*
+	* Returns whether any object is hit within the interval of the given ray and sets the intersection
+	* parameter to the RayIntersection representing the closest point of intersection.
+	* On an intersection the ray is shortened to end at the intersection point.
+	* @param[in,out] ray The ray.
+	* @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	* @return True if the ray intersected an object; otherwise false.
+	*/
+	bool calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const;
+
+	/*
+	* Returns whether any object is hit within the interval of the given ray and sets the intersection
+	* parameter to the RayIntersection representing the point of intersection.
+	* @param[in] ray The ray.
+	* @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	* @return True if the ray intersected an object; otherwise false.
+	*/
+	bool calculateAnyIntersection(const Ray &ray, RayIntersection &intersection) const;
+
 	/*
 	* Adds a geometrical object to the scene.
 	* @param[in] geometry Pointer to an IGeometry.
@@ -63,9 +88,15 @@ public:
 
 	/**
 	* Gets the vector containing all lights in the scene.
-	* @return Pointer to a vector containing all the lights in the scene.
+	* @return Reference to a vector containing all the lights in the scene.
 	*/
-	std::shared_ptr<const std::vector<std::shared_ptr<ILight>>> getLights() const;
+	const std::vector<std::shared_ptr<ILight>> &getLights() const;
+
+	/**
+	* Gets the hierarchy over the lights in the scene, which is built when the scene is preprocessed.
+	* @return Pointer to the light hierarchy.
+	*/
+	std::shared_ptr<const LightTree> getLightTree() const;
 
 	/**
 	* Gets the acceleration structure that is used to find speed up
@@ -97,18 +128,74 @@ public:
 	*/
 	int getAmbientOcclusionSamples() const;
 
+	/**
+	* Gets the distance up to which geometry occludes the ambient light.
+	* @return The distance up to which geometry occludes the ambient light.
+	*/
+	float getAmbientOcclusionRadius() const;
+
+	/**
+	* Gets whether or not ambient occlusion is cached.
+	* @return Whether or not ambient occlusion is cached.
+	*/
+	bool getAmbientOcclusionCacheEnabled() const;
+
+	/**
+	* Gets the cache of ambient occlusion, which is cleared when the scene is preprocessed.
+	* The cache is shared by all threads and filled while rendering.
+	* @return Pointer to the cache of ambient occlusion.
+	*/
+	std::shared_ptr<IrradianceCache> getAmbientOcclusionCache() const;
+
+	/**
+	* Gets whether or not the irradiance of diffuse surfaces is cached.
+	* @return Whether or not the irradiance of diffuse surfaces is cached.
+	*/
+	bool getIrradianceCacheEnabled() const;
+
+	/**
+	* Gets the number of rays traced to compute a record of the irradiance cache.
+	* @return The number of rays traced to compute a record of the irradiance cache.
+	*/
+	int getIrradianceSamples() const;
+
+	/**
+	* Gets the cache of the irradiance of diffuse surfaces, which is cleared when the scene is preprocessed.
+	* The cache is shared by all threads and filled while rendering.
+	* @return Pointer to the cache of irradiance.
+	*/
+	std::shared_ptr<IrradianceCache> getIrradianceCache() const;
+
 	/**
 	* Gets the square root of the number of samples taken per pixel.
 	* @return The square root of the number of samples taken per pixel.
 	*/
 	int getSamplesPerPixel() const;
 
+	/**
+	* Gets the noise threshold used for adaptive sampling.
+	* @return The maximum relative error of a converged pixel, or zero if adaptive sampling is disabled.
+	*/
+	float getNoiseThreshold() const;
+
 	/**
 	* Gets the maximum ray tracing recursion depth.
 	* @return The maximum ray tracing recursion depth.
 	*/
 	int getMaxTraceDepth() const;
 
+	/**
+	* Gets the number of lights chosen from the light hierarchy at every shading point.
+	* @return The number of lights chosen at every shading point, or zero if every light is sampled.
+	*/
+	int getSampledLightCount() const;
+
+	/**
+	* Gets the number of shadow rays traced towards an area light before deciding whether it is partially occluded.
+	* @return The number of probing shadow rays, or zero if adaptive shadow sampling is disabled.
+	*/
+	int getShadowProbeCount() const;
+
 	/**
 	* Sets the acceleration structure that is used to find speed up
 	* the intersection calculations.
@@ -129,6 +216,19 @@ public:
 	*/
 	void setRayTracer(std::shared_ptr<IRayTracer> rayTracer);
 
+	/**
+	* Gets the sampler that generates the random numbers of every sample.
+	* @return Pointer to a sampler.
+	*/
+	std::shared_ptr<const ISampler> getSampler() const;
+
+	/**
+	* Sets the sampler that generates the random numbers of every sample, which are used by the camera,
+	* the lights, ambient occlusion and path tracing alike. The default sampler generates independent random numbers.
+	* @param[in] sampler Pointer to a sampler.
+	*/
+	void setSampler(std::shared_ptr<ISampler> sampler);
+
 	/**
 	* Sets the number of light samples to be taken per square unit of surface area.
 	* @param density The number of light samples to be taken per square unit of surface area.
@@ -146,18 +246,72 @@ public:
 	*/
 	void setAmbientOcclusionSamples(int numSamples);
 
+	/**
+	* Sets the distance up to which geometry occludes the ambient light. Occlusion rays end at this distance,
+	* which makes them cheaper and keeps distant geometry from darkening open areas.
+	* @param radius The distance up to which geometry occludes the ambient light, or infinity for any distance.
+	*/
+	void setAmbientOcclusionRadius(float radius);
+
+	/**
+	* Sets whether or not ambient occlusion is cached. When enabled, the occlusion computed at a point is reused
+	* by nearby points on similarly oriented surfaces, which interpolate it from the records around them.
+	* @param enabled Whether or not ambient occlusion is cached.
+	*/
+	void setAmbientOcclusionCacheEnabled(bool enabled);
+
+	/**
+	* Sets whether or not the irradiance of diffuse surfaces is cached. When enabled, diffuse surfaces interpolate the indirect light
+	* they receive from the records around them instead of tracing a reflected ray, and where no record is valid a new one is computed
+	* by tracing a hemisphere of rays. This affects both ray tracers: the PathTracer caches the first diffuse surface along every path,
+	* and the RayTracer caches the diffuse surfaces seen from the camera when path tracing is enabled.
+	* @param enabled Whether or not the irradiance of diffuse surfaces is cached.
+	*/
+	void setIrradianceCacheEnabled(bool enabled);
+
+	/**
+	* Sets the number of rays traced to compute a record of the irradiance cache.
+	* As every record is reused by many pixels, its noise shows as blotches rather than grain, so this should be large.
+	* @param numSamples The number of rays traced to compute a record of the irradiance cache.
+	*/
+	void setIrradianceSamples(int numSamples);
+
 	/**
 	* Sets the square root of the number of samples taken per pixel.
 	* @param numSamples The square root of the number of samples taken per pixel.
 	*/
 	void setSamplesPerPixel(int numSamples);
 
+	/**
+	* Sets the noise threshold used for adaptive sampling. When enabled, pixels are sampled until the 95% confidence
+	* interval of their luminance is narrower than the threshold relative to their luminance. Samples saved on
+	* converged pixels are spent on the tiles that are still noisy, so on average a pixel never gets more samples than without adaptive sampling.
+	* Adaptive sampling needs more than one sample per pixel, with a single sample every pixel is sampled uniformly.
+	* @param threshold The maximum relative error of a converged pixel, or zero to disable adaptive sampling.
+	*/
+	void setNoiseThreshold(float threshold);
+
 	/**
 	* Sets the maximum ray tracing recursion depth.
 	* @param maxDepth The maximum ray tracing recursion depth.
 	*/
 	void setMaxTraceDepth(int maxDepth);
 
+	/**
+	* Sets the number of lights chosen from the light hierarchy at every shading point. Lights are chosen in proportion
+	* to their estimated contribution, so the cost of shading grows logarithmically instead of linearly with the number of lights.
+	* @param count The number of lights chosen at every shading point, or zero to sample every light.
+	*/
+	void setSampledLightCount(int count);
+
+	/**
+	* Sets the number of shadow rays traced towards an area light before deciding whether it is partially occluded.
+	* If all probes agree the point is taken to be fully lit or fully shadowed, so the remaining light samples
+	* skip their shadow rays or are skipped altogether. Only points in the penumbra trace a shadow ray for every sample.
+	* @param count The number of probing shadow rays, or zero to disable adaptive shadow sampling.
+	*/
+	void setShadowProbeCount(int count);
+
 	/**
 	* Sets whether or not path tracing is enabled.
 	* @param enabled Whether or not path tracing is enabled.
@@ -173,24 +327,70 @@ public:
 	*/
 	std::shared_ptr<Image> render(std::shared_ptr<ICamera>, int width, int height);
 
-private:
 	/**
 	* Perform any preprocessing necessary before rendering the scene.
 	*/
 	void preprocess();
 
-	Vec3Df renderPixel(std::shared_ptr<ICamera> camera, int x, int y);
+	/**
+	* Traces a single ray from the given camera through the given point of a pixel.
+	* The scene and camera must have been preprocessed.
+	* @param[in] camera Pointer to the camera that observes the scene.
+	* @param x The x-coordinate of the pixel.
+	* @param y The y-coordinate of the pixel.
+	* @param subPixelX X-offset within the pixel itself, range [0, 1].
+	* @param subPixelY Y-offset within the pixel itself, range [0, 1].
+	* @return The color seen along the ray.
+	*/
+	Vec3Df renderSample(const ICamera *camera, int x, int y, float subPixelX, float subPixelY) const;
+
+private:
+	/**
+	* Renders every pixel with the same number of stratified samples.
+	*/
+	void renderUniform(const ICamera *camera, Image &image);
+
+	/**
+	* Renders the pixels with a varying number of samples, depending on how noisy they are.
+	*/
+	void renderAdaptive(const ICamera *camera, Image &image);
+
+	/**
+	* Samples the pixels of a tile until they have converged or the budget runs out.
+	* @param[in] camera Pointer to the camera that observes the scene.
+	* @param[in] tile The tile to be sampled.
+	* @param[in,out] estimators The estimators of all pixels of the image, stored row by row.
+	* @param width The width of the image.
+	* @param minSamples The number of samples every pixel gets, regardless of the budget.
+	* @param maxSamples The number of samples after which a pixel is no longer sampled.
+	* @param[in,out] budget The number of samples that may be taken, reduced by the number of samples taken.
+	* @return True if every pixel of the tile has converged or reached the maximum number of samples; otherwise false.
+	*/
+	bool sampleTile(const ICamera *camera, const Tile &tile, std::vector<PixelEstimator> &estimators, int width, int minSamples, int maxSamples, long long &budget) const;
+
+	Vec3Df renderPixel(const ICamera *camera, int x, int y);
 
 	bool pathTracingEnabled;
 	int ambientOcclusionSamples;
+	float ambientOcclusionRadius;
+	bool ambientOcclusionCacheEnabled;
+	bool irradianceCacheEnabled;
+	int irradianceSamples;
 	int samplesPerPixel;
+	float noiseThreshold;
 	int maxTraceDepth;
+	int sampledLightCount;
+	int shadowProbeCount;
 	float lightSampleDensity;
 	Vec3Df ambientLight;
 	std::shared_ptr<IAccelerationStructure> accelerator;
 	std::shared_ptr<IRayTracer> rayTracer;
+	std::shared_ptr<ISampler> sampler;
 	std::shared_ptr<std::vector<std::shared_ptr<IGeometry>>> geometry;
 	std::shared_ptr<std::vector<std::shared_ptr<ILight>>> lights;
+	std::shared_ptr<LightTree> lightTree;
+	std::shared_ptr<IrradianceCache> ambientOcclusionCache;
+	std::shared_ptr<IrradianceCache> irradianceCache;
 };
 
 #endif
\ No newline at end of file
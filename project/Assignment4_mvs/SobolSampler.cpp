@@ -0,0 +1,113 @@
+#include <cassert>
+
+#include "Random.h"
+#include "SobolSampler.h"
+
+namespace {
+	/**
+	 * The direction numbers of the first four dimensions of the Sobol sequence, one for every bit of the index.
+	 */
+	struct SobolDirections {
+		SobolDirections();
+
+		unsigned int numbers[SobolSampler::Dimensions][32];
+	};
+
+	SobolDirections::SobolDirections() {
+		// The degree, coefficients and initial direction numbers of the primitive polynomials from Joe and Kuo.
+		// The first dimension is the van der Corput sequence.
+		const unsigned int degrees[SobolSampler::Dimensions] = { 0, 1, 2, 3 };
+		const unsigned int coefficients[SobolSampler::Dimensions] = { 0, 0, 1, 1 };
+		const unsigned int initial[SobolSampler::Dimensions][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 3, 0 }, { 1, 3, 1 } };
+
+		for (int k = 0; k < 32; k++) {
+			this->numbers[0][k] = 1u << (31 - k);
+		}
+
+		for (unsigned int d = 1; d < SobolSampler::Dimensions; d++) {
+			unsigned int s = degrees[d];
+			unsigned int m[32];
+
+			for (unsigned int k = 0; k < 32; k++) {
+				if (k < s) {
+					m[k] = initial[d][k];
+				}
+				else {
+					// m_k = 2^s m_(k-s) ^ m_(k-s) ^ sum of 2^j a_j m_(k-j)
+					m[k] = m[k - s] ^ (m[k - s] << s);
+
+					for (unsigned int j = 1; j < s; j++) {
+						if ((coefficients[d] >> (s - 1 - j)) & 1)
+							m[k] ^= m[k - j] << j;
+					}
+				}
+
+				this->numbers[d][k] = m[k] << (31 - k);
+			}
+		}
+	}
+
+	const SobolDirections directions;
+
+	unsigned int reverseBits(unsigned int value) {
+		value = (value << 16) | (value >> 16);
+		value = ((value & 0x00FF00FF) << 8) | ((value & 0xFF00FF00) >> 8);
+		value = ((value & 0x0F0F0F0F) << 4) | ((value & 0xF0F0F0F0) >> 4);
+		value = ((value & 0x33333333) << 2) | ((value & 0xCCCCCCCC) >> 2);
+		value = ((value & 0x55555555) << 1) | ((value & 0xAAAAAAAA) >> 1);
+
+		return value;
+	}
+}
+
+SobolSampler::SobolSampler()
+: seed(0) {
+}
+
+SobolSampler::SobolSampler(unsigned int seed)
+: seed(seed) {
+}
+
+unsigned int SobolSampler::getSample(int x, int y, unsigned int sampleIndex, unsigned int dimension) const {
+	// Every pixel has its own scrambles, which are derived from the pixel and the group of the dimension
+	unsigned int group = dimension / Dimensions;
+	unsigned int seed = Random::generate(Random::getPixelKey(x, y), this->seed, group);
+
+	return SobolSampler::getScrambledSobol(sampleIndex, dimension % Dimensions, seed);
+}
+
+unsigned int SobolSampler::getSobol(unsigned int index, unsigned int dimension) {
+	assert(dimension < Dimensions);
+
+	const unsigned int *numbers = directions.numbers[dimension];
+	unsigned int result = 0;
+
+	// Combine the direction numbers of the bits set in the index
+	for (int k = 0; index != 0; index >>= 1, k++) {
+		if (index & 1)
+			result ^= numbers[k];
+	}
+
+	return result;
+}
+
+unsigned int SobolSampler::scramble(unsigned int value, unsigned int seed) {
+	// A hash in which every bit only depends on the bits below it, applied to the reversed
+	// bits it makes every bit depend on the more significant ones, which is a nested uniform scramble
+	value = reverseBits(value);
+
+	value ^= value * 0x3D20ADEA;
+	value += seed;
+	value *= (seed >> 16) | 1;
+	value ^= value * 0x05526C56;
+	value ^= value * 0x53A22864;
+
+	return reverseBits(value);
+}
+
+unsigned int SobolSampler::getScrambledSobol(unsigned int index, unsigned int dimension, unsigned int seed) {
+	// Scrambling the index shuffles the points without breaking up the stratified subsets of the sequence
+	unsigned int shuffledIndex = SobolSampler::scramble(index, seed);
+
+	return SobolSampler::scramble(SobolSampler::getSobol(shuffledIndex, dimension), Random::generate(seed, dimension, 0));
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef SOBOLSAMPLER_H
+#define SOBOLSAMPLER_H
+
+#include "ISampler.h"
+
+/**
+ * Represents a sampler which generates an Owen-scrambled Sobol sequence for every pixel.
+ *
+ * The dimensions are taken from the first four dimensions of the Sobol sequence in groups of four.
+ * The points of every group are scrambled with a different seed and visited in a differently shuffled order,
+ * so the groups are uncorrelated while the points of each group remain well stratified.
+ * The scrambling is the hash-based nested uniform scrambling described by Burley.
+ */
+class SobolSampler : public ISampler {
+public:
+	/**
+	 * The number of dimensions of the Sobol sequence, larger dimensions are padded with further groups.
+	 */
+	static const unsigned int Dimensions = 4;
+
+	/**
+	 * Initializes a SobolSampler with the default seed.
+	 */
+	SobolSampler();
+
+	/**
+	 * Initializes a SobolSampler with the given seed, which selects a different set of scrambles.
+	 * @param seed The seed.
+	 */
+	explicit SobolSampler(unsigned int seed);
+
+	/**
+	 * Gets the given dimension of a sample of the given pixel.
+	 * @param x The x-coordinate of the pixel.
+	 * @param y The y-coordinate of the pixel.
+	 * @param sampleIndex The index of the sample within the pixel.
+	 * @param dimension The index of the random number within the sample.
+	 * @return An unsigned integer in the range [0, UINT_MAX], which maps to [0, 1) when divided by 2^32.
+	 */
+	unsigned int getSample(int x, int y, unsigned int sampleIndex, unsigned int dimension) const;
+
+	/**
+	 * Gets a point of the unscrambled Sobol sequence.
+	 * @param index The index of the point.
+	 * @param dimension The dimension, in the range [0, Dimensions).
+	 * @return The coordinate of the point as a fixed point number with 32 fractional bits.
+	 */
+	static unsigned int getSobol(unsigned int index, unsigned int dimension);
+
+	/**
+	 * Applies a nested uniform (Owen) scramble to the given fixed point number, which randomly permutes
+	 * every half of every interval in the binary subdivision of [0, 1) and thus preserves stratification.
+	 * @param value The fixed point number.
+	 * @param seed The seed selecting the scramble.
+	 * @return The scrambled number.
+	 */
+	static unsigned int scramble(unsigned int value, unsigned int seed);
+
+	/**
+	 * Gets a point of the Owen-scrambled Sobol sequence whose points are visited in a shuffled order.
+	 * @param index The index of the point.
+	 * @param dimension The dimension, in the range [0, Dimensions).
+	 * @param seed The seed selecting the scramble and shuffle.
+	 * @return The coordinate of the point as a fixed point number with 32 fractional bits.
+	 */
+	static unsigned int getScrambledSobol(unsigned int index, unsigned int dimension, unsigned int seed);
+
+private:
+	unsigned int seed;
+};
+
+#endif
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "Constants.h"
 #include "Random.h"
+#include "Ray.h"
 #include "RayIntersection.h"
 #include "SphereGeometry.h"
 #include "SurfacePoint.h"
@@ -20,9 +21,11 @@ float SphereGeometry::getArea() const {
 	return 4.0f * Constants::Pi * this->radius * this->radius;
 }
 
-bool SphereGeometry::calculateClosestIntersection(const Vec3Df &origin, const Vec3Df &dir, RayIntersection &intersection) const {
+bool SphereGeometry::calculateClosestIntersection(Ray &ray, RayIntersection &intersection) const {
+	const Vec3Df &dir = ray.direction;
+
 	// Ray origin relative to the sphere
-	Vec3Df local = origin - this->position;
+	Vec3Df local = ray.origin - this->position;
 
 	// Calculate the a, b and c constants of the quadratic equation
 	float a = Vec3Df::dotProduct(dir, dir);
@@ -51,26 +54,34 @@ bool SphereGeometry::calculateClosestIntersection(const Vec3Df &origin, const Ve
 	float tmin = q / a;
 	float tmax = c / q;
 
+	float distance;
+	bool isInside;
+
 	// Check whether the intersection was on the inside or
 	// outside of the sphere and set the parameters accordingly
 	if (tmin <= 0.0f || tmax < tmin) {
-		intersection.distance = tmax;
-		intersection.isInside = false;
+		distance = tmax;
+		isInside = false;
 	}
 	else {
-		intersection.distance = tmin;
-		intersection.isInside = true;
+		distance = tmin;
+		isInside = true;
 	}
 
-	// If the distance is negative the intersection occured behind the ray
-	if (intersection.distance <= 0.0f)
+	// If the distance is negative the intersection occured behind the ray,
+	// otherwise it still has to lie within the interval of the ray
+	if (distance <= 0.0f || distance < ray.minDistance || distance > ray.maxDistance)
 		return false;
 
 	// Set the intersection parameters
-	intersection.geometry = this->shared_from_this();
-	intersection.origin = origin;
+	intersection.geometry = this;
+	intersection.distance = distance;
+	intersection.isInside = isInside;
+	intersection.origin = ray.origin;
 	intersection.direction = dir;
-	intersection.hitPoint = origin + dir * intersection.distance;
+	intersection.hitPoint = ray.getPoint(distance);
+
+	ray.maxDistance = distance;
 
 	return true;
 }
@@ -90,10 +101,22 @@ void SphereGeometry::getSurfacePoint(const RayIntersection &intersection, Surfac
 }
 
 void SphereGeometry::getRandomSurfacePoint(SurfacePoint &surface) const {
-	surface.geometry = this->shared_from_this();
-	surface.point = Random::sampleUnitSphere() * this->radius + this->position;
-	surface.normal = surface.point - this->position;
-	surface.normal.normalize();
+	// Generate two random numbers
+	float u, v;
+	Random::sampleUnitSquare(u, v);
+
+	this->sampleSurfacePoint(u, v, surface);
+}
+
+void SphereGeometry::sampleSurfacePoint(float u, float v, SurfacePoint &surface) const {
+	// By Archimedes' theorem the height of a uniformly distributed point on the sphere is uniformly distributed
+	float z = 1.0f - 2.0f * u;
+	float r = sqrtf(std::max(0.0f, 1.0f - z * z));
+	float phi = v * Constants::TwoPi;
+
+	surface.geometry = this;
+	surface.normal = Vec3Df(r * cosf(phi), r * sinf(phi), z);
+	surface.point = surface.normal * this->radius + this->position;
 	surface.texCoords = this->getTextureCoordinates(surface.point);
 	surface.isInside = false;
 }
@@ -15,10 +15,34 @@ Vec3Df SurfacePoint::reflectedLight(const Vec3Df &incommingVector, const Vec3Df
 	return this->geometry->getMaterial()->reflectedLight(*this, incommingVector, reflectedVector, lightColor);
 }
 
+Vec3Df SurfacePoint::diffuseLight(const Vec3Df &reflectedVector, const Vec3Df &irradiance) const {
+	return this->geometry->getMaterial()->diffuseLight(*this, reflectedVector, irradiance);
+}
+
+bool SurfacePoint::isDiffuse() const {
+	return this->geometry->getMaterial()->isDiffuse();
+}
+
+Vec3Df SurfacePoint::sampleIncomingVector(const Vec3Df &reflectedVector) const {
+	return this->geometry->getMaterial()->sampleIncomingVector(*this, reflectedVector);
+}
+
+float SurfacePoint::getProbabilityDensity(const Vec3Df &incommingVector, const Vec3Df &reflectedVector) const {
+	return this->geometry->getMaterial()->getProbabilityDensity(*this, incommingVector, reflectedVector);
+}
+
 Vec3Df SurfacePoint::specularLight(const Vec3Df &reflectedVector, const Scene *scene, int iteration) const {
 	return this->geometry->getMaterial()->specularLight(*this, reflectedVector, scene, iteration);
 }
 
 Vec3Df SurfacePoint::transmittedLight(const Vec3Df &reflectedVector, const Scene *scene, int iteration) const {
 	return this->geometry->getMaterial()->transmittedLight(*this, reflectedVector, scene, iteration);
+}
+
+bool SurfacePoint::calculateSpecularRay(const Vec3Df &reflectedVector, Vec3Df &direction, Vec3Df &weight) const {
+	return this->geometry->getMaterial()->calculateSpecularRay(*this, reflectedVector, direction, weight);
+}
+
+bool SurfacePoint::calculateTransmittedRay(const Vec3Df &reflectedVector, Vec3Df &direction, Vec3Df &weight, Vec3Df &absorbance) const {
+	return this->geometry->getMaterial()->calculateTransmittedRay(*this, reflectedVector, direction, weight, absorbance);
 }
\ No newline at end of file
@@ -39,6 +39,35 @@ public:
 	 */
 	Vec3Df reflectedLight(const Vec3Df &incommingVector, const Vec3Df &reflectedVector, const Vec3Df &lightColor) const;
 
+	/**
+	 * Calculates the light diffusely reflected towards the given vector when the surface receives the given irradiance.
+	 * @param[in] reflectedVector The vector that the light is reflected towards.
+	 * @param[in] irradiance The irradiance of the surface.
+	 * @return The light diffusely reflected towards the given vector.
+	 */
+	Vec3Df diffuseLight(const Vec3Df &reflectedVector, const Vec3Df &irradiance) const;
+
+	/**
+	 * Gets whether the surface reflects light only diffusely through its BRDFs.
+	 * @return True if the surface only reflects light diffusely through its BRDFs; otherwise false.
+	 */
+	bool isDiffuse() const;
+
+	/**
+	 * Samples an incoming vector for the BRDFs of the surface.
+	 * @param[in] reflectedVector The vector that the light is reflected towards.
+	 * @return The sampled incoming vector, which may lie below the surface.
+	 */
+	Vec3Df sampleIncomingVector(const Vec3Df &reflectedVector) const;
+
+	/**
+	 * Calculates the probability density per unit solid angle with which sampleIncomingVector returns the given incoming vector.
+	 * @param[in] incommingVector The vector from which the light is comming.
+	 * @param[in] reflectedVector The vector that the light is reflected towards.
+	 * @return The probability density of the incoming vector.
+	 */
+	float getProbabilityDensity(const Vec3Df &incommingVector, const Vec3Df &reflectedVector) const;
+
 	/**
 	 * Calculates the specularly reflected light towards the given vector.
 	 * @param[in] reflectedVector The vector that the light is reflected towards.
@@ -57,6 +86,25 @@ public:
 	*/
 	Vec3Df transmittedLight(const Vec3Df &reflectedVector, const Scene *scene, int iteration) const;
 
+	/**
+	 * Calculates the ray along which specularLight traces the light that is specularly reflected towards the given vector.
+	 * @param[in] reflectedVector The vector that the light is reflected towards.
+	 * @param[out] direction The direction of the specular ray.
+	 * @param[out] weight The fraction of the light along the specular ray that is reflected towards the given vector.
+	 * @return True if the surface reflects light specularly towards the given vector; otherwise false.
+	 */
+	bool calculateSpecularRay(const Vec3Df &reflectedVector, Vec3Df &direction, Vec3Df &weight) const;
+
+	/**
+	 * Calculates the ray along which transmittedLight traces the light that is transmitted towards the given vector.
+	 * @param[in] reflectedVector The vector that the light is reflected towards.
+	 * @param[out] direction The direction of the refracted ray.
+	 * @param[out] weight The fraction of the light along the refracted ray that is transmitted, not accounting for absorption.
+	 * @param[out] absorbance The absorbance per unit of distance along the refracted ray in the Beer-Lambert law.
+	 * @return True if the surface transmits light towards the given vector; otherwise false.
+	 */
+	bool calculateTransmittedRay(const Vec3Df &reflectedVector, Vec3Df &direction, Vec3Df &weight, Vec3Df &absorbance) const;
+
 	/**
 	 * The point on the surface.
 	 */
@@ -80,7 +128,7 @@ public:
 	/**
 	 * The geometry which this surface belongs to.
 	 */
-	std::shared_ptr<const IGeometry> geometry;
+	const IGeometry *geometry;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cassert>
+
+#include "TileScheduler.h"
+
+TileScheduler::TileScheduler(int width, int height, int tileSize, int workerCount)
+: queues(workerCount) {
+	assert(width > 0);
+	assert(height > 0);
+	assert(tileSize > 0);
+	assert(workerCount > 0);
+
+	int columns = (width + tileSize - 1) / tileSize;
+	int rows = (height + tileSize - 1) / tileSize;
+
+	// The Hilbert curve fills a square whose size is a power of two
+	int size = 1;
+
+	while (size < columns || size < rows)
+		size *= 2;
+
+	this->tiles.reserve(columns * rows);
+
+	// Walk the curve and keep the tiles that lie inside the image
+	for (int i = 0; i < size * size; i++) {
+		int column, row;
+		TileScheduler::getHilbertPoint(size, i, column, row);
+
+		if (column >= columns || row >= rows)
+			continue;
+
+		Tile tile;
+		tile.x = column * tileSize;
+		tile.y = row * tileSize;
+		tile.width = std::min(tileSize, width - tile.x);
+		tile.height = std::min(tileSize, height - tile.y);
+
+		this->tiles.push_back(tile);
+	}
+
+	// Give each worker an equally sized contiguous part of the curve
+	int tileCount = this->tiles.size();
+
+	for (int i = 0; i < workerCount; i++) {
+		this->queues[i].next.store((int)((long long)tileCount * i / workerCount));
+		this->queues[i].end = (int)((long long)tileCount * (i + 1) / workerCount);
+	}
+
+	this->completedTiles.store(0);
+}
+
+bool TileScheduler::getNextTile(int worker, Tile &tile) {
+	int queueCount = this->queues.size();
+
+	assert(worker >= 0 && worker < queueCount);
+
+	// Start with the queue of the worker itself, then try to steal from the others
+	for (int i = 0; i < queueCount; i++) {
+		Queue &queue = this->queues[(worker + i) % queueCount];
+
+		// Skip queues that are known to be empty to avoid incrementing their position any further
+		if (queue.next.load(std::memory_order_relaxed) >= queue.end)
+			continue;
+
+		int index = queue.next.fetch_add(1, std::memory_order_relaxed);
+
+		if (index < queue.end) {
+			tile = this->tiles[index];
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int TileScheduler::completeTile() {
+	return this->completedTiles.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+int TileScheduler::getCompletedTileCount() const {
+	return this->completedTiles.load(std::memory_order_relaxed);
+}
+
+int TileScheduler::getTileCount() const {
+	return this->tiles.size();
+}
+
+void TileScheduler::getHilbertPoint(int size, int distance, int &x, int &y) {
+	x = 0;
+	y = 0;
+
+	// Descend the curve one level at a time, each level determines one bit of both coordinates
+	for (int s = 1; s < size; s *= 2) {
+		int rx = 1 & (distance / 2);
+		int ry = 1 & (distance ^ rx);
+
+		// Rotate the quadrant so that the curve connects to its neighbours
+		if (ry == 0) {
+			if (rx == 1) {
+				x = s - 1 - x;
+				y = s - 1 - y;
+			}
+
+			std::swap(x, y);
+		}
+
+		x += s * rx;
+		y += s * ry;
+		distance /= 4;
+	}
+}
\ No newline at end of file
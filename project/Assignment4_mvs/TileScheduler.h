@@ -0,0 +1,108 @@
+#ifndef TILESCHEDULER_H
+#define TILESCHEDULER_H
+
+#include <atomic>
+#include <vector>
+
+/**
+ * Represents a rectangular region of an image.
+ */
+struct Tile {
+	/**
+	 * The x-coordinate of the top left pixel of the tile.
+	 */
+	int x;
+
+	/**
+	 * The y-coordinate of the top left pixel of the tile.
+	 */
+	int y;
+
+	/**
+	 * The width of the tile in pixels.
+	 */
+	int width;
+
+	/**
+	 * The height of the tile in pixels.
+	 */
+	int height;
+};
+
+/**
+ * Divides an image into square tiles and hands them out to a number of worker threads.
+ *
+ * The tiles are ordered along a Hilbert curve, so consecutive tiles are neighbours in the image and
+ * share most of the geometry their rays hit. The curve is cut into one contiguous queue per worker.
+ * A worker first takes tiles from its own queue and then steals from the queues of the others.
+ * Tiles are taken by atomically incrementing the position of a queue, so no locks are needed.
+ */
+class TileScheduler {
+public:
+	/**
+	 * The width and height in pixels of the tiles in which images are rendered.
+	 */
+	static const int DefaultTileSize = 32;
+
+	/**
+	 * Initializes a TileScheduler for an image of the given size.
+	 * @param width The width of the image.
+	 * @param height The height of the image.
+	 * @param tileSize The width and height of the tiles, tiles at the right and bottom edge may be smaller.
+	 * @param workerCount The number of workers, each of which is given its own queue.
+	 */
+	TileScheduler(int width, int height, int tileSize, int workerCount);
+
+	/**
+	 * Gets the next tile for the given worker. This method may be called concurrently.
+	 * @param worker The index of the worker, in the range [0, workerCount).
+	 * @param[out] tile The next tile to be rendered.
+	 * @return True if a tile was found; false if all tiles have been handed out.
+	 */
+	bool getNextTile(int worker, Tile &tile);
+
+	/**
+	 * Marks a tile as completed. This method may be called concurrently.
+	 * @return The number of tiles completed so far, including this one.
+	 */
+	int completeTile();
+
+	/**
+	 * Gets the number of tiles completed so far.
+	 * @return The number of tiles completed so far.
+	 */
+	int getCompletedTileCount() const;
+
+	/**
+	 * Gets the total number of tiles.
+	 * @return The total number of tiles.
+	 */
+	int getTileCount() const;
+
+private:
+	/**
+	 * A contiguous range of tiles. The vector does not align the queues to cache lines, so each queue is padded to two lines
+	 * of 64 bytes. The position and end of one queue are then at least a line apart from those of its neighbours, and workers
+	 * never share a cache line with the position of another queue, however the queues happen to be aligned.
+	 */
+	struct Queue {
+		std::atomic<int> next;
+		int end;
+		char padding[2 * 64 - sizeof(std::atomic<int>) - sizeof(int)];
+	};
+
+	/**
+	 * Converts a distance along the Hilbert curve filling a square of the given size to a point in that square.
+	 * @param size The size of the square, which must be a power of two.
+	 * @param distance The distance along the curve.
+	 * @param[out] x The x-coordinate of the point.
+	 * @param[out] y The y-coordinate of the point.
+	 */
+	static void getHilbertPoint(int size, int distance, int &x, int &y);
+
+	std::vector<Tile> tiles;
+	std::vector<Queue> queues;
+	std::atomic<int> completedTiles;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include <cassert>
+#include <cstring>
+#include <math.h>
+
+#include "Transform.h"
+
+Transform::Transform()
+: Transform(Vec3Df(1.0f, 0.0f, 0.0f), Vec3Df(0.0f, 1.0f, 0.0f), Vec3Df(0.0f, 0.0f, 1.0f), Vec3Df()) {
+}
+
+Transform::Transform(const Vec3Df &xAxis, const Vec3Df &yAxis, const Vec3Df &zAxis, const Vec3Df &translation) {
+	// The axes form the columns of the linear part
+	for (int i = 0; i < 3; i++) {
+		this->matrix[i][0] = xAxis[i];
+		this->matrix[i][1] = yAxis[i];
+		this->matrix[i][2] = zAxis[i];
+		this->matrix[i][3] = translation[i];
+	}
+
+	this->calculateInverse();
+}
+
+Transform::Transform(const float matrix[3][4], const float inverse[3][4]) {
+	memcpy(this->matrix, matrix, sizeof(this->matrix));
+	memcpy(this->inverse, inverse, sizeof(this->inverse));
+}
+
+Transform Transform::translate(const Vec3Df &offset) {
+	return Transform(Vec3Df(1.0f, 0.0f, 0.0f), Vec3Df(0.0f, 1.0f, 0.0f), Vec3Df(0.0f, 0.0f, 1.0f), offset);
+}
+
+Transform Transform::scale(const Vec3Df &factors) {
+	return Transform(Vec3Df(factors[0], 0.0f, 0.0f), Vec3Df(0.0f, factors[1], 0.0f), Vec3Df(0.0f, 0.0f, factors[2]), Vec3Df());
+}
+
+Transform Transform::rotate(const Vec3Df &axis, float angle) {
+	Vec3Df a = axis;
+	a.normalize();
+
+	float c = cosf(angle);
+	float s = sinf(angle);
+	float t = 1.0f - c;
+
+	// Rodrigues' rotation formula, written out per column
+	return Transform(
+		Vec3Df(t * a[0] * a[0] + c, t * a[0] * a[1] + s * a[2], t * a[0] * a[2] - s * a[1]),
+		Vec3Df(t * a[0] * a[1] - s * a[2], t * a[1] * a[1] + c, t * a[1] * a[2] + s * a[0]),
+		Vec3Df(t * a[0] * a[2] + s * a[1], t * a[1] * a[2] - s * a[0], t * a[2] * a[2] + c),
+		Vec3Df());
+}
+
+Transform Transform::operator*(const Transform &other) const {
+	float matrix[3][4];
+	float inverse[3][4];
+
+	// (A * B)(p) = A(B(p)) and (A * B)^-1 = B^-1 * A^-1
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 4; j++) {
+			matrix[i][j] =
+				this->matrix[i][0] * other.matrix[0][j] +
+				this->matrix[i][1] * other.matrix[1][j] +
+				this->matrix[i][2] * other.matrix[2][j];
+
+			inverse[i][j] =
+				other.inverse[i][0] * this->inverse[0][j] +
+				other.inverse[i][1] * this->inverse[1][j] +
+				other.inverse[i][2] * this->inverse[2][j];
+		}
+
+		matrix[i][3] += this->matrix[i][3];
+		inverse[i][3] += other.inverse[i][3];
+	}
+
+	return Transform(matrix, inverse);
+}
+
+Transform Transform::getInverse() const {
+	return Transform(this->inverse, this->matrix);
+}
+
+float Transform::getDeterminant() const {
+	const float (*m)[4] = this->matrix;
+
+	return
+		m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+		m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+		m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+bool Transform::isSimilarity() const {
+	Vec3Df axes[3];
+
+	for (int j = 0; j < 3; j++)
+		axes[j] = Vec3Df(this->matrix[0][j], this->matrix[1][j], this->matrix[2][j]);
+
+	// Allow for rounding in transformations composed of several rotations
+	float squaredScale = axes[0].getSquaredLength();
+	float tolerance = 1e-5f * squaredScale;
+
+	for (int j = 0; j < 3; j++) {
+		if (fabsf(axes[j].getSquaredLength() - squaredScale) > tolerance)
+			return false;
+
+		if (fabsf(Vec3Df::dotProduct(axes[j], axes[(j + 1) % 3])) > tolerance)
+			return false;
+	}
+
+	return true;
+}
+
+Vec3Df Transform::transformPoint(const Vec3Df &point) const {
+	const float (*m)[4] = this->matrix;
+
+	return Vec3Df(
+		m[0][0] * point[0] + m[0][1] * point[1] + m[0][2] * point[2] + m[0][3],
+		m[1][0] * point[0] + m[1][1] * point[1] + m[1][2] * point[2] + m[1][3],
+		m[2][0] * point[0] + m[2][1] * point[1] + m[2][2] * point[2] + m[2][3]);
+}
+
+Vec3Df Transform::transformVector(const Vec3Df &vector) const {
+	const float (*m)[4] = this->matrix;
+
+	return Vec3Df(
+		m[0][0] * vector[0] + m[0][1] * vector[1] + m[0][2] * vector[2],
+		m[1][0] * vector[0] + m[1][1] * vector[1] + m[1][2] * vector[2],
+		m[2][0] * vector[0] + m[2][1] * vector[1] + m[2][2] * vector[2]);
+}
+
+Vec3Df Transform::transformNormal(const Vec3Df &normal) const {
+	const float (*m)[4] = this->inverse;
+
+	// Multiply by the transpose of the inverse
+	return Vec3Df(
+		m[0][0] * normal[0] + m[1][0] * normal[1] + m[2][0] * normal[2],
+		m[0][1] * normal[0] + m[1][1] * normal[1] + m[2][1] * normal[2],
+		m[0][2] * normal[0] + m[1][2] * normal[1] + m[2][2] * normal[2]);
+}
+
+BoundingBox Transform::transformBoundingBox(const BoundingBox &box) const {
+	BoundingBox result = BoundingBox();
+
+	// An empty box stays empty
+	if (box.isEmpty())
+		return result;
+
+	// Include all eight transformed corners
+	for (int i = 0; i < 8; i++) {
+		Vec3Df corner(
+			(i & 1) ? box.max[0] : box.min[0],
+			(i & 2) ? box.max[1] : box.min[1],
+			(i & 4) ? box.max[2] : box.min[2]);
+
+		result.includePoint(this->transformPoint(corner));
+	}
+
+	return result;
+}
+
+void Transform::calculateInverse() {
+	const float (*m)[4] = this->matrix;
+	float determinant = this->getDeterminant();
+
+	assert(determinant != 0.0f);
+
+	float invDeterminant = 1.0f / determinant;
+
+	// Invert the linear part using its adjugate
+	this->inverse[0][0] = (m[1][1] * m[2][2] - m[1][2] * m[2][1]) * invDeterminant;
+	this->inverse[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * invDeterminant;
+	this->inverse[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invDeterminant;
+	this->inverse[1][0] = (m[1][2] * m[2][0] - m[1][0] * m[2][2]) * invDeterminant;
+	this->inverse[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invDeterminant;
+	this->inverse[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * invDeterminant;
+	this->inverse[2][0] = (m[1][0] * m[2][1] - m[1][1] * m[2][0]) * invDeterminant;
+	this->inverse[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * invDeterminant;
+	this->inverse[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * invDeterminant;
+
+	// The inverse translation undoes the translation in the inverted frame
+	for (int i = 0; i < 3; i++) {
+		this->inverse[i][3] = -(
+			this->inverse[i][0] * m[0][3] +
+			this->inverse[i][1] * m[1][3] +
+			this->inverse[i][2] * m[2][3]);
+	}
+}
\ No newline at end of file
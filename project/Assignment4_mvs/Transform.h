@@ -0,0 +1,119 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "BoundingBox.h"
+#include "Vec3D.h"
+
+/**
+ * Represents an affine transformation, consisting of a linear part and a translation.
+ * The inverse is kept alongside the matrix so that normals and inverse transformations are cheap.
+ */
+class Transform {
+public:
+	/**
+	 * Initializes the identity transformation.
+	 */
+	Transform();
+
+	/**
+	 * Initializes a transformation which maps the standard basis onto the given axes
+	 * and the origin onto the given translation.
+	 * @param[in] xAxis The image of the x-axis.
+	 * @param[in] yAxis The image of the y-axis.
+	 * @param[in] zAxis The image of the z-axis.
+	 * @param[in] translation The image of the origin.
+	 */
+	Transform(const Vec3Df &xAxis, const Vec3Df &yAxis, const Vec3Df &zAxis, const Vec3Df &translation);
+
+	/**
+	 * Creates a transformation which translates by the given offset.
+	 * @param[in] offset The offset to translate by.
+	 * @return The translation.
+	 */
+	static Transform translate(const Vec3Df &offset);
+
+	/**
+	 * Creates a transformation which scales by the given factor along each axis.
+	 * @param[in] factors The scale factor along each axis.
+	 * @return The scaling.
+	 */
+	static Transform scale(const Vec3Df &factors);
+
+	/**
+	 * Creates a transformation which rotates around the given axis.
+	 * @param[in] axis The axis to rotate around.
+	 * @param angle The angle of the rotation in radians.
+	 * @return The rotation.
+	 */
+	static Transform rotate(const Vec3Df &axis, float angle);
+
+	/**
+	 * Composes this transformation with the given transformation.
+	 * @param[in] other The transformation which is applied first.
+	 * @return A transformation which applies other followed by this transformation.
+	 */
+	Transform operator*(const Transform &other) const;
+
+	/**
+	 * Gets the inverse of this transformation.
+	 * @return The inverse of this transformation.
+	 */
+	Transform getInverse() const;
+
+	/**
+	 * Gets the determinant of the linear part of this transformation.
+	 * @return The determinant of the linear part of this transformation.
+	 */
+	float getDeterminant() const;
+
+	/**
+	 * Tests whether this transformation is a similarity, which scales every direction by the same factor.
+	 * Rotations, reflections, uniform scales and translations are similarities, non-uniform scales and shears are not.
+	 * @return True if the columns of the linear part are orthogonal and of equal length; otherwise false.
+	 */
+	bool isSimilarity() const;
+
+	/**
+	 * Transforms a point.
+	 * @param[in] point The point to transform.
+	 * @return The transformed point.
+	 */
+	Vec3Df transformPoint(const Vec3Df &point) const;
+
+	/**
+	 * Transforms a direction, which is not affected by the translation.
+	 * @param[in] vector The direction to transform.
+	 * @return The transformed direction.
+	 */
+	Vec3Df transformVector(const Vec3Df &vector) const;
+
+	/**
+	 * Transforms a surface normal by the inverse transpose, so that it stays orthogonal to the surface.
+	 * @param[in] normal The normal to transform.
+	 * @return The transformed normal, which is not normalized.
+	 */
+	Vec3Df transformNormal(const Vec3Df &normal) const;
+
+	/**
+	 * Computes a bounding box which bounds the transformed bounding box.
+	 * @param[in] box The bounding box to transform.
+	 * @return A bounding box which bounds the transformed bounding box.
+	 */
+	BoundingBox transformBoundingBox(const BoundingBox &box) const;
+
+private:
+	/**
+	 * Initializes a transformation from the given matrix and its inverse.
+	 */
+	Transform(const float matrix[3][4], const float inverse[3][4]);
+
+	/**
+	 * Computes the inverse of the matrix.
+	 */
+	void calculateInverse();
+
+	float matrix[3][4];
+	float inverse[3][4];
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <cassert>
+
+#include "mesh.h"
+#include "Ray.h"
+#include "RayIntersection.h"
+#include "TrianglePrimitiveSet.h"
+
+#if TRIANGLE_PACKET_SIZE == 8
+#include <immintrin.h>
+
+// Thin wrappers around the AVX2 intrinsics, so the packet kernel can be written once for every width
+typedef __m256 PacketFloat;
+
+static inline PacketFloat packetSet(float value) { return _mm256_set1_ps(value); }
+static inline PacketFloat packetGather(const float *data, const unsigned int *indices) { return _mm256_i32gather_ps(data, _mm256_loadu_si256((const __m256i*)indices), 4); }
+static inline PacketFloat packetAdd(PacketFloat a, PacketFloat b) { return _mm256_add_ps(a, b); }
+static inline PacketFloat packetSub(PacketFloat a, PacketFloat b) { return _mm256_sub_ps(a, b); }
+static inline PacketFloat packetMul(PacketFloat a, PacketFloat b) { return _mm256_mul_ps(a, b); }
+static inline PacketFloat packetDiv(PacketFloat a, PacketFloat b) { return _mm256_div_ps(a, b); }
+static inline PacketFloat packetAnd(PacketFloat a, PacketFloat b) { return _mm256_and_ps(a, b); }
+static inline PacketFloat packetNotEqual(PacketFloat a, PacketFloat b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_OQ); }
+static inline PacketFloat packetGreaterEqual(PacketFloat a, PacketFloat b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static inline PacketFloat packetLessEqual(PacketFloat a, PacketFloat b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline int packetMask(PacketFloat a) { return _mm256_movemask_ps(a); }
+static inline void packetStore(float *data, PacketFloat a) { _mm256_storeu_ps(data, a); }
+#elif TRIANGLE_PACKET_SIZE == 4
+#include <emmintrin.h>
+
+// Thin wrappers around the SSE2 intrinsics, so the packet kernel can be written once for every width
+typedef __m128 PacketFloat;
+
+static inline PacketFloat packetSet(float value) { return _mm_set1_ps(value); }
+static inline PacketFloat packetGather(const float *data, const unsigned int *indices) { return _mm_set_ps(data[indices[3]], data[indices[2]], data[indices[1]], data[indices[0]]); }
+static inline PacketFloat packetAdd(PacketFloat a, PacketFloat b) { return _mm_add_ps(a, b); }
+static inline PacketFloat packetSub(PacketFloat a, PacketFloat b) { return _mm_sub_ps(a, b); }
+static inline PacketFloat packetMul(PacketFloat a, PacketFloat b) { return _mm_mul_ps(a, b); }
+static inline PacketFloat packetDiv(PacketFloat a, PacketFloat b) { return _mm_div_ps(a, b); }
+static inline PacketFloat packetAnd(PacketFloat a, PacketFloat b) { return _mm_and_ps(a, b); }
+static inline PacketFloat packetNotEqual(PacketFloat a, PacketFloat b) { return _mm_cmpneq_ps(a, b); }
+static inline PacketFloat packetGreaterEqual(PacketFloat a, PacketFloat b) { return _mm_cmpge_ps(a, b); }
+static inline PacketFloat packetLessEqual(PacketFloat a, PacketFloat b) { return _mm_cmple_ps(a, b); }
+static inline int packetMask(PacketFloat a) { return _mm_movemask_ps(a); }
+static inline void packetStore(float *data, PacketFloat a) { _mm_storeu_ps(data, a); }
+#endif
+
+TrianglePrimitiveSet::TrianglePrimitiveSet(const Mesh *mesh) {
+	assert(mesh);
+
+	unsigned int count = mesh->triangles.size();
+
+	this->vertexX.resize(count);
+	this->vertexY.resize(count);
+	this->vertexZ.resize(count);
+	this->edge1X.resize(count);
+	this->edge1Y.resize(count);
+	this->edge1Z.resize(count);
+	this->edge2X.resize(count);
+	this->edge2Y.resize(count);
+	this->edge2Z.resize(count);
+
+	// Gather the vertices of each triangle and precompute its edges
+	for (unsigned int i = 0; i < count; i++) {
+		const Triangle &triangle = mesh->triangles[i];
+		Vec3Df vertex0 = mesh->vertices[triangle.v[0]].p;
+		Vec3Df edge1 = mesh->vertices[triangle.v[1]].p - vertex0;
+		Vec3Df edge2 = mesh->vertices[triangle.v[2]].p - vertex0;
+
+		this->vertexX[i] = vertex0[0];
+		this->vertexY[i] = vertex0[1];
+		this->vertexZ[i] = vertex0[2];
+		this->edge1X[i] = edge1[0];
+		this->edge1Y[i] = edge1[1];
+		this->edge1Z[i] = edge1[2];
+		this->edge2X[i] = edge2[0];
+		this->edge2Y[i] = edge2[1];
+		this->edge2Z[i] = edge2[2];
+	}
+}
+
+unsigned int TrianglePrimitiveSet::getPrimitiveCount() const {
+	return this->vertexX.size();
+}
+
+BoundingBox TrianglePrimitiveSet::getBoundingBox(unsigned int index) const {
+	Vec3Df vertex0(this->vertexX[index], this->vertexY[index], this->vertexZ[index]);
+	Vec3Df edge1(this->edge1X[index], this->edge1Y[index], this->edge1Z[index]);
+	Vec3Df edge2(this->edge2X[index], this->edge2Y[index], this->edge2Z[index]);
+
+	// Construct an empty bounding box
+	BoundingBox result = BoundingBox();
+
+	// Insert all three vertices
+	result.includePoint(vertex0);
+	result.includePoint(vertex0 + edge1);
+	result.includePoint(vertex0 + edge2);
+
+	return result;
+}
+
+bool TrianglePrimitiveSet::calculateClosestIntersection(const unsigned int *indices, unsigned int count, Ray &ray, RayIntersection &intersection) const {
+	unsigned int padded[PacketSize];
+	float distances[PacketSize], u[PacketSize], v[PacketSize], determinants[PacketSize];
+	bool intersectsAny = false;
+
+	for (unsigned int i = 0; i < count; i += PacketSize) {
+		const unsigned int *packet = indices + i;
+
+		// Fill the last packet up by repeating the last triangle
+		if (count - i < PacketSize) {
+			for (unsigned int j = 0; j < PacketSize; j++) {
+				padded[j] = indices[std::min(i + j, count - 1)];
+			}
+
+			packet = padded;
+		}
+
+		int mask = this->intersectPacket(packet, ray, distances, u, v, determinants);
+
+		// The ray shrinks with every intersection, so only accept intersections
+		// that are closer than the closest intersection within this packet
+		for (int j = 0; mask != 0; j++, mask >>= 1) {
+			if (!(mask & 1) || distances[j] > ray.maxDistance)
+				continue;
+
+			ray.maxDistance = distances[j];
+			intersection.distance = distances[j];
+			intersection.primitiveIndex = packet[j];
+			intersection.barycentricCoordinates = Vec2Df(u[j], v[j]);
+			intersection.isInside = determinants[j] < 0.0f;
+			intersectsAny = true;
+		}
+	}
+
+	// Only compute the remaining fields for the closest intersection
+	if (intersectsAny) {
+		intersection.origin = ray.origin;
+		intersection.direction = ray.direction;
+		intersection.hitPoint = ray.getPoint(intersection.distance);
+	}
+
+	return intersectsAny;
+}
+
+bool TrianglePrimitiveSet::calculateAnyIntersection(const unsigned int *indices, unsigned int count, const Ray &ray, RayIntersection &intersection) const {
+	unsigned int padded[PacketSize];
+	float distances[PacketSize], u[PacketSize], v[PacketSize], determinants[PacketSize];
+
+	for (unsigned int i = 0; i < count; i += PacketSize) {
+		const unsigned int *packet = indices + i;
+
+		// Fill the last packet up by repeating the last triangle
+		if (count - i < PacketSize) {
+			for (unsigned int j = 0; j < PacketSize; j++) {
+				padded[j] = indices[std::min(i + j, count - 1)];
+			}
+
+			packet = padded;
+		}
+
+		int mask = this->intersectPacket(packet, ray, distances, u, v, determinants);
+
+		if (mask == 0)
+			continue;
+
+		// An intersection was found, return the first one
+		int j = 0;
+
+		while (!(mask & (1 << j))) {
+			j++;
+		}
+
+		intersection.distance = distances[j];
+		intersection.primitiveIndex = packet[j];
+		intersection.barycentricCoordinates = Vec2Df(u[j], v[j]);
+		intersection.isInside = determinants[j] < 0.0f;
+		intersection.origin = ray.origin;
+		intersection.direction = ray.direction;
+		intersection.hitPoint = ray.getPoint(distances[j]);
+
+		return true;
+	}
+
+	return false;
+}
+
+int TrianglePrimitiveSet::intersectPacket(const unsigned int *indices, const Ray &ray, float *distances, float *u, float *v, float *determinants) const {
+#if TRIANGLE_PACKET_SIZE > 1
+	const Vec3Df &origin = ray.origin;
+	const Vec3Df &dir = ray.direction;
+
+	// The same Moller-Trumbore algorithm as intersect, but for PacketSize triangles at once
+	PacketFloat edge1X = packetGather(&this->edge1X[0], indices);
+	PacketFloat edge1Y = packetGather(&this->edge1Y[0], indices);
+	PacketFloat edge1Z = packetGather(&this->edge1Z[0], indices);
+	PacketFloat edge2X = packetGather(&this->edge2X[0], indices);
+	PacketFloat edge2Y = packetGather(&this->edge2Y[0], indices);
+	PacketFloat edge2Z = packetGather(&this->edge2Z[0], indices);
+
+	PacketFloat dirX = packetSet(dir[0]);
+	PacketFloat dirY = packetSet(dir[1]);
+	PacketFloat dirZ = packetSet(dir[2]);
+
+	// p = dir x edge2
+	PacketFloat pX = packetSub(packetMul(dirY, edge2Z), packetMul(dirZ, edge2Y));
+	PacketFloat pY = packetSub(packetMul(dirZ, edge2X), packetMul(dirX, edge2Z));
+	PacketFloat pZ = packetSub(packetMul(dirX, edge2Y), packetMul(dirY, edge2X));
+
+	PacketFloat determinant = packetAdd(packetAdd(packetMul(edge1X, pX), packetMul(edge1Y, pY)), packetMul(edge1Z, pZ));
+	PacketFloat invDeterminant = packetDiv(packetSet(1.0f), determinant);
+
+	// t = origin - vertex0
+	PacketFloat tX = packetSub(packetSet(origin[0]), packetGather(&this->vertexX[0], indices));
+	PacketFloat tY = packetSub(packetSet(origin[1]), packetGather(&this->vertexY[0], indices));
+	PacketFloat tZ = packetSub(packetSet(origin[2]), packetGather(&this->vertexZ[0], indices));
+
+	PacketFloat packetU = packetMul(packetAdd(packetAdd(packetMul(tX, pX), packetMul(tY, pY)), packetMul(tZ, pZ)), invDeterminant);
+
+	// q = t x edge1
+	PacketFloat qX = packetSub(packetMul(tY, edge1Z), packetMul(tZ, edge1Y));
+	PacketFloat qY = packetSub(packetMul(tZ, edge1X), packetMul(tX, edge1Z));
+	PacketFloat qZ = packetSub(packetMul(tX, edge1Y), packetMul(tY, edge1X));
+
+	PacketFloat packetV = packetMul(packetAdd(packetAdd(packetMul(dirX, qX), packetMul(dirY, qY)), packetMul(dirZ, qZ)), invDeterminant);
+	PacketFloat distance = packetMul(packetAdd(packetAdd(packetMul(edge2X, qX), packetMul(edge2Y, qY)), packetMul(edge2Z, qZ)), invDeterminant);
+
+	PacketFloat zero = packetSet(0.0f);
+	PacketFloat one = packetSet(1.0f);
+
+	// A triangle is hit if the ray is not parallel to it, the barycentric coordinates
+	// lie within the triangle and the distance lies within the interval of the ray
+	PacketFloat hit = packetNotEqual(determinant, zero);
+	hit = packetAnd(hit, packetGreaterEqual(packetU, zero));
+	hit = packetAnd(hit, packetLessEqual(packetU, one));
+	hit = packetAnd(hit, packetGreaterEqual(packetV, zero));
+	hit = packetAnd(hit, packetLessEqual(packetAdd(packetU, packetV), one));
+	hit = packetAnd(hit, packetGreaterEqual(distance, zero));
+	hit = packetAnd(hit, packetGreaterEqual(distance, packetSet(ray.minDistance)));
+	hit = packetAnd(hit, packetLessEqual(distance, packetSet(ray.maxDistance)));
+
+	int mask = packetMask(hit);
+
+	// Only write out the results if any triangle was hit
+	if (mask != 0) {
+		packetStore(distances, distance);
+		packetStore(u, packetU);
+		packetStore(v, packetV);
+		packetStore(determinants, determinant);
+	}
+
+	return mask;
+#else
+	bool isInside;
+
+	if (!this->intersect(indices[0], ray, distances[0], u[0], v[0], isInside))
+		return 0;
+
+	determinants[0] = isInside ? -1.0f : 1.0f;
+
+	return 1;
+#endif
+}
+
+bool TrianglePrimitiveSet::intersect(unsigned int index, const Ray &ray, float &distance, float &u, float &v, bool &isInside) const {
+	const Vec3Df &origin = ray.origin;
+	const Vec3Df &dir = ray.direction;
+
+	Vec3Df edge1(this->edge1X[index], this->edge1Y[index], this->edge1Z[index]);
+	Vec3Df edge2(this->edge2X[index], this->edge2Y[index], this->edge2Z[index]);
+
+	Vec3Df p = Vec3Df::crossProduct(dir, edge2);
+	float determinant = Vec3Df::dotProduct(edge1, p);
+
+	// The ray is parallel to the triangle
+	if (determinant == 0.0f)
+		return false;
+
+	float invDeterminant = 1.0f / determinant;
+	Vec3Df t = origin - Vec3Df(this->vertexX[index], this->vertexY[index], this->vertexZ[index]);
+
+	u = Vec3Df::dotProduct(t, p) * invDeterminant;
+
+	if (u < 0.0f || u > 1.0f)
+		return false;
+
+	Vec3Df q = Vec3Df::crossProduct(t, edge1);
+
+	v = Vec3Df::dotProduct(dir, q) * invDeterminant;
+
+	if (v < 0.0f || u + v > 1.0f)
+		return false;
+
+	distance = Vec3Df::dotProduct(edge2, q) * invDeterminant;
+
+	// The intersection occurred behind the ray or outside its interval
+	if (distance < 0.0f || distance < ray.minDistance || distance > ray.maxDistance)
+		return false;
+
+	// The determinant is negative when the ray points in the same direction as the normal,
+	// which means that the triangle was hit from the inside
+	isInside = determinant < 0.0f;
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#ifndef TRIANGLEPRIMITIVESET_H
+#define TRIANGLEPRIMITIVESET_H
+
+#include <vector>
+
+#include "IPrimitiveSet.h"
+
+// The number of triangles that are intersected at once, which is the width of the widest
+// available vector instructions: 8 for AVX2, 4 for SSE2 and 1 when neither is available.
+// Define TRIANGLE_PACKET_SIZE as 1 to force the scalar implementation.
+#if defined(TRIANGLE_PACKET_SIZE)
+#elif defined(__AVX2__)
+#define TRIANGLE_PACKET_SIZE 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRIANGLE_PACKET_SIZE 4
+#else
+#define TRIANGLE_PACKET_SIZE 1
+#endif
+
+class Mesh;
+
+/**
+ * Stores the triangles of a mesh for intersection as packed arrays.
+ *
+ * Each triangle is stored as its first vertex and its two edges leaving that vertex,
+ * with each component in a separate array, so intersecting a range of triangles
+ * touches only contiguous memory and requires no per-triangle objects.
+ *
+ * Triangles are intersected in packets of TRIANGLE_PACKET_SIZE using vector instructions,
+ * with a scalar implementation of the same algorithm when no vector instructions are available.
+ */
+class TrianglePrimitiveSet : public IPrimitiveSet {
+public:
+	/**
+	 * Initializes a TrianglePrimitiveSet with the triangles of the given mesh.
+	 * @param[in] mesh The mesh containing the triangles.
+	 */
+	TrianglePrimitiveSet(const Mesh *mesh);
+
+	/**
+	 * Gets the number of primitives in the set.
+	 * @return The number of primitives in the set.
+	 */
+	unsigned int getPrimitiveCount() const;
+
+	/**
+	 * Returns a bounding box that bounds the triangle with the given index.
+	 * @param index The index of the triangle.
+	 * @return A bounding box that bounds the triangle.
+	 */
+	BoundingBox getBoundingBox(unsigned int index) const;
+
+	/*
+	 * Intersects the given triangles with the ray and updates the intersection parameter
+	 * if any of them is hit within the ray's interval.
+	 * @param[in] indices The indices of the triangles to intersect.
+	 * @param count The number of triangles to intersect.
+	 * @param[in,out] ray The ray, its maximum distance is set to the distance of the intersection if one was found.
+	 * @param[in,out] intersection Reference to a RayIntersection representing the closest intersection point of the ray.
+	 * @return True if the intersection was updated; otherwise false.
+	 */
+	bool calculateClosestIntersection(const unsigned int *indices, unsigned int count, Ray &ray, RayIntersection &intersection) const;
+
+	/*
+	 * Returns whether any of the given triangles is hit by the given ray and sets the intersection parameter
+	 * to the RayIntersection representing the point of intersection.
+	 * @param[in] indices The indices of the triangles to intersect.
+	 * @param count The number of triangles to intersect.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
+	 * @param[out] intersection Reference to a RayIntersection representing the intersection point of the ray.
+	 * @return True if the ray intersected a triangle; otherwise false.
+	 */
+	bool calculateAnyIntersection(const unsigned int *indices, unsigned int count, const Ray &ray, RayIntersection &intersection) const;
+
+private:
+	/**
+	 * The number of triangles that are intersected at once.
+	 */
+	static const int PacketSize = TRIANGLE_PACKET_SIZE;
+
+	/**
+	 * Intersects the ray with a packet of PacketSize triangles.
+	 * @param[in] indices The indices of the triangles, exactly PacketSize of them.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
+	 * @param[out] distances The distance of the intersection with each triangle.
+	 * @param[out] u The barycentric coordinate of the intersection with respect to the second vertex of each triangle.
+	 * @param[out] v The barycentric coordinate of the intersection with respect to the third vertex of each triangle.
+	 * @param[out] determinants The determinant for each triangle, which is negative if the back of the triangle was hit.
+	 * @return A bit mask in which bit i is set if the ray intersected the i-th triangle.
+	 */
+	int intersectPacket(const unsigned int *indices, const Ray &ray, float *distances, float *u, float *v, float *determinants) const;
+
+	/**
+	 * Intersects the ray with the triangle with the given index using the Moller-Trumbore algorithm.
+	 * @param index The index of the triangle.
+	 * @param[in] ray The ray, only intersections within its interval are accepted.
+	 * @param[out] distance The distance at which the intersection occurred.
+	 * @param[out] u The barycentric coordinate of the intersection with respect to the second vertex.
+	 * @param[out] v The barycentric coordinate of the intersection with respect to the third vertex.
+	 * @param[out] isInside Whether the ray hit the back of the triangle.
+	 * @return True if the ray intersected the triangle; otherwise false.
+	 */
+	bool intersect(unsigned int index, const Ray &ray, float &distance, float &u, float &v, bool &isInside) const;
+
+	std::vector<float> vertexX;
+	std::vector<float> vertexY;
+	std::vector<float> vertexZ;
+	std::vector<float> edge1X;
+	std::vector<float> edge1Y;
+	std::vector<float> edge1Z;
+	std::vector<float> edge2X;
+	std::vector<float> edge2Y;
+	std::vector<float> edge2Z;
+};
+
+#endif
\ No newline at end of file